@@ -0,0 +1,229 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program measures topological_sort_module() on synthetic
+ * import graphs of 10,000 to 100,000 modules.
+ *
+ * The module descriptors are built at run time, rather than with
+ * DECLARE_MODULE, so that the size and shape of the graph can be
+ * varied without generating source files.
+ *
+ * The sort runs on a thread with a 64KiB stack.  The 'chain' graph,
+ * where each module imports the next, visits every module at depth
+ * before any is sorted; it completes because the sort does not
+ * recurse.
+ *
+ * The time per (modules + imports) should stay roughly constant as
+ * the graphs grow, showing the sort is linear.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "module_init.h"
+
+#define STACK_SIZE   (64 * 1024)
+#define N_REPEATS    5
+#define MAX_IMPORTS  4
+
+typedef enum graph_shape_t {
+    GS_CHAIN,                   /* i imports i + 1. */
+    GS_RANDOM,                  /* i imports up to MAX_IMPORTS of (i, n). */
+    GS_FAN_IN                   /* i imports n - 1. */
+} graph_shape_t;
+
+static const char *shape_names[] = {
+    "chain",
+    "random",
+    "fan-in"
+};
+
+typedef struct graph_t {
+    unsigned                   n_modules;
+    unsigned                   n_edges;
+    struct module_init_info_t *modules;
+    module_init_info_t       **imports;
+    uint8_t                   *states;
+    unsigned                  *ordinals;
+} graph_t;
+
+
+static void
+graph_destroy(graph_t *g)
+{
+    free(g->modules);
+    free(g->imports);
+    free(g->states);
+    free(g->ordinals);
+}
+
+
+static int
+graph_create(graph_t *g, graph_shape_t shape, unsigned n)
+{
+    unsigned i;
+
+    g->n_modules = n;
+    g->n_edges   = 0;
+    g->modules   = calloc(n, sizeof(module_init_info_t));
+    g->imports   = calloc((size_t)n * MAX_IMPORTS,
+                          sizeof(module_init_info_t *));
+    g->states    = calloc(n, sizeof(uint8_t));
+    g->ordinals  = calloc(n, sizeof(unsigned));
+    if (g->modules == NULL || g->imports == NULL ||
+        g->states == NULL || g->ordinals == NULL) {
+        graph_destroy(g);
+        return 0;
+    }
+
+    srand(n);
+    for (i = 0; i < n; ++i) {
+        struct module_init_info_t  *mip   = &g->modules[i];
+        module_init_info_t        **first = &g->imports[g->n_edges];
+
+        mip->module_name = "synthetic";
+        mip->state       = &g->states[i];
+        mip->ordinal     = &g->ordinals[i];
+        switch (shape) {
+        case GS_CHAIN:
+            if (i + 1 < n) {
+                g->imports[g->n_edges++] = &g->modules[i + 1];
+            }
+            break;
+
+        case GS_RANDOM: {
+            unsigned k = (unsigned)rand() % (MAX_IMPORTS + 1);
+
+            while (k > 0 && i + 1 < n) {
+                unsigned imp = i + 1 + (unsigned)rand() % (n - i - 1);
+
+                g->imports[g->n_edges++] = &g->modules[imp];
+                --k;
+            }
+            break;
+        }
+
+        case GS_FAN_IN:
+            if (i + 1 < n) {
+                g->imports[g->n_edges++] = &g->modules[n - 1];
+            }
+            break;
+        }
+        mip->imports.start = first;
+        mip->imports.stop  = &g->imports[g->n_edges];
+    }
+    return 1;
+}
+
+
+static double
+graph_sort(graph_t *g)
+{
+    module_init_handle_t handle;
+    struct timespec      start;
+    struct timespec      stop;
+    unsigned             i;
+
+    memset(g->states, IS_UNINITIALIZED, g->n_modules);
+
+    module_handle_initialize(&handle, g->n_modules);
+    if (handle.table == NULL) {
+        return -1.0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < g->n_modules; ++i) {
+        topological_sort_module(&handle, &g->modules[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    assert(handle.init_state == IR_SUCCESS);
+    assert(handle.table_index == handle.table_size);
+    module_handle_finalize(&handle);
+
+    return ((double)(stop.tv_sec - start.tv_sec) * 1e9 +
+            (double)(stop.tv_nsec - start.tv_nsec));
+}
+
+
+static void *
+benchmark(void *arg)
+{
+    static const unsigned sizes[] = { 10000, 20000, 50000, 100000 };
+    graph_shape_t         shape;
+    unsigned              s;
+
+    (void)arg;
+    printf("%-8s  %8s  %8s  %10s  %12s\n",
+           "Shape", "Modules", "Imports", "Best ms", "ns/(V+E)");
+
+    for (shape = GS_CHAIN; shape <= GS_FAN_IN; ++shape) {
+        for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+            graph_t  g;
+            double   best = -1.0;
+            unsigned r;
+
+            if (!graph_create(&g, shape, sizes[s])) {
+                printf("Out of memory.\n");
+                return NULL;
+            }
+
+            for (r = 0; r < N_REPEATS; ++r) {
+                double ns = graph_sort(&g);
+
+                if (best < 0.0 || ns < best) {
+                    best = ns;
+                }
+            }
+
+            printf("%-8s  %8u  %8u  %10.3f  %12.2f\n",
+                   shape_names[shape], g.n_modules, g.n_edges,
+                   best / 1e6, best / (g.n_modules + g.n_edges));
+            graph_destroy(&g);
+        }
+    }
+    return NULL;
+}
+
+
+int main(void)
+{
+    pthread_attr_t attr;
+    pthread_t      thread;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, STACK_SIZE);
+    if (pthread_create(&thread, &attr, benchmark, NULL) != 0) {
+        printf("Unable to create benchmark thread.\n");
+        return 1;
+    }
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+    return 0;
+}
@@ -0,0 +1,94 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program initializes 'mod_words', which allocates its table
+ * from its arena, and shows the arena before and after the module is
+ * finalized.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "module_init.h"
+
+typedef struct mod_word_t {
+    struct mod_word_t *next;
+    char               text[];
+} mod_word_t;
+
+extern mod_word_t        **mod_words;
+extern unsigned            mod_words_hash(const char *text);
+extern module_init_info_t  MODULE_INIT(mod_words);
+
+
+static void
+show_arena(void)
+{
+    const module_arena_t *arena = MODULE_INIT(mod_words).arena;
+
+    printf("*** Arena of mod_words: %s, %zu of %zu KiB allocated\n",
+           arena->base != NULL ? "mapped" : "not mapped",
+           arena->used / 1024, MODULE_INIT(mod_words).arena_size / 1024);
+}
+
+
+int main(void)
+{
+    module_init_handle_t handle;
+    const mod_word_t    *w;
+    struct timespec      start;
+    struct timespec      stop;
+
+    printf("*** Initializing modules.\n");
+    module_initialization(&handle);
+    if (handle.init_state != IR_SUCCESS) {
+        printf("Module initialization failed: %d\n", handle.init_state);
+        module_handle_finalize(&handle);
+        return 1;
+    }
+    show_arena();
+
+    for (w = mod_words[mod_words_hash("word4242")]; w != NULL; w = w->next) {
+        if (strcmp(w->text, "word4242") == 0) {
+            printf("*** Found '%s'\n", w->text);
+        }
+    }
+
+    printf("\n\n*** Finalizing modules.\n");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    module_finalization(&handle);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    show_arena();
+    printf("*** Finalization took %.3f ms\n",
+           (double)(stop.tv_sec - start.tv_sec) * 1e3 +
+           (double)(stop.tv_nsec - start.tv_nsec) / 1e6);
+
+    module_handle_finalize(&handle);
+    return 0;
+}
@@ -0,0 +1,61 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program initializes two modules that each wait 100ms for
+ * simulated I/O.  Both waits are started at once, so initialization
+ * takes about 100ms, though only the calling thread runs the
+ * initialization functions.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "module_init_parallel.h"
+
+int main(void)
+{
+    module_init_handle_t handle;
+    uint64_t             start;
+
+    printf("*** Initializing modules on one thread.\n");
+    start = module_clock_ns(CLOCK_MONOTONIC);
+    module_initialization_parallel(&handle, 1);
+    if (handle.init_state != IR_SUCCESS) {
+        printf("Module initialization failed: %d\n", handle.init_state);
+        module_handle_finalize(&handle);
+        return 1;
+    }
+    printf("Initialized in %s100ms.\n",
+           module_clock_ns(CLOCK_MONOTONIC) - start < 200000000u
+           ? "about " : "more than ");
+
+    printf("\n\n*** Finalizing modules.\n");
+    module_finalization(&handle);
+    module_handle_finalize(&handle);
+    return 0;
+}
@@ -0,0 +1,61 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program initializes a cacheable module, using a cache kept in
+ * the 'module_cache' directory.  The first run builds and caches the
+ * module's table; later runs map it from the cache.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include "module_init_cache.h"
+
+int main(void)
+{
+    module_init_handle_t handle;
+    module_disk_cache_t  cache;
+
+    mkdir("module_cache", 0777);
+    if (module_disk_cache_open(&cache, "module_cache") != 0) {
+        printf("Unable to open the module cache.\n");
+        return 1;
+    }
+
+    printf("*** Initializing modules.\n");
+    module_initialization(&handle);
+    if (handle.init_state == IR_SUCCESS || handle.init_state == IR_FAILED) {
+        printf("\n\n*** Finalizing modules.\n");
+        module_finalization(&handle);
+    }
+
+    module_handle_finalize(&handle);
+    module_disk_cache_close(&cache);
+    return 0;
+}
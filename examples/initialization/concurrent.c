@@ -0,0 +1,100 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program initializes modules from three threads at once.
+ *
+ * The first thread initializes all modules.  Once it has started
+ * 'mod_slow', a second thread calls module_initialization() with its
+ * own handle, and a third uses the lazy 'mod_lazy'.  Both wait for
+ * the first: the second then finds every module initialized, and the
+ * third initializes 'mod_lazy' on demand.  Each module is initialized
+ * exactly once.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "module_init.h"
+
+extern module_init_info_t MODULE_INIT(mod_slow);
+extern void mod_lazy_use(void);
+
+static void *
+initialize(void *arg)
+{
+    module_initialization((module_init_handle_t *)arg);
+    return NULL;
+}
+
+
+static void *
+use_lazy(void *arg)
+{
+    (void)arg;
+    mod_lazy_use();
+    return NULL;
+}
+
+
+int main(void)
+{
+    const struct timespec poll = { 0, 1000000L };
+    module_init_handle_t  first;
+    module_init_handle_t  second;
+    pthread_t             threads[3];
+
+    printf("*** Initializing modules on three threads.\n");
+    if (pthread_create(&threads[0], NULL, initialize, &first) != 0) {
+        printf("Unable to create a thread.\n");
+        return 1;
+    }
+    while (module_state(&MODULE_INIT(mod_slow)) == IS_UNINITIALIZED) {
+        nanosleep(&poll, NULL);
+    }
+    if (pthread_create(&threads[1], NULL, initialize, &second) != 0 ||
+        pthread_create(&threads[2], NULL, use_lazy, NULL) != 0) {
+        printf("Unable to create a thread.\n");
+        return 1;
+    }
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    pthread_join(threads[2], NULL);
+
+    printf("\n\n*** First handle: %d, %u modules.  "
+           "Second handle: %d, %u modules.\n",
+           first.init_state, first.table_index,
+           second.init_state, second.table_index);
+
+    printf("\n\n*** Finalizing modules.\n");
+    module_finalization(&second);
+    module_handle_finalize(&second);
+    module_finalization(&first);
+    module_handle_finalize(&first);
+    return 0;
+}
@@ -31,12 +31,21 @@
 
 #include "module_init.h"
 
+/* INIT_OPTIONS
+ *
+ *  The module_init_option_t values used to initialize modules.  The
+ *  Makefile builds variants of this program with different options.
+ */
+#if !defined(INIT_OPTIONS)
+#define INIT_OPTIONS 0
+#endif
+
 int main(void)
 {
     module_init_handle_t handle;
 
     printf("*** Initializing modules.\n");
-    module_initialization(&handle);
+    module_initialization_with(&handle, INIT_OPTIONS);
 
     switch (handle.init_state) {
     case IR_SUCCESS:
@@ -59,6 +68,18 @@ int main(void)
         printf("Module '%s' failed to initialized\n",
                handle.table[handle.table_index]->module_name);
         break;
+
+    case IR_MEMORY:
+        printf("Error, unable to allocate the module table\n");
+        break;
+
+    case IR_PHASE:
+        printf("Error, module '%s' imports '%s' of a later phase\n",
+               handle.table[0]->module_name, handle.table[1]->module_name);
+        break;
+
+    case IR_RELOAD:             /* Only returned by module_reload(). */
+        break;
     }
 
     switch (handle.init_state) {
@@ -67,6 +88,12 @@ int main(void)
         printf("\n\n*** Finalizing modules.\n");
         module_finalization(&handle);
         break;
+
+    case IR_CYCLE:  /* No module initialized. */
+    case IR_MEMORY:
+    case IR_PHASE:
+    case IR_RELOAD:
+        break;
     }
 
     module_handle_finalize(&handle);
@@ -0,0 +1,60 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program exits with module_quick_exit().  The log of 'mod_log'
+ * is flushed, but 'mod_list', whose finalization function only frees
+ * memory, is not finalized.
+ *
+ *   MODULE_INIT_FULL_EXIT=1 ./exit_example
+ *
+ * finalizes every module.
+ */
+#include <stdio.h>
+
+#include "module_init_exit.h"
+
+extern void mod_log_write(const char *line);
+
+int main(void)
+{
+    module_init_handle_t handle;
+
+    printf("*** Initializing modules.\n");
+    module_initialization(&handle);
+    if (handle.init_state != IR_SUCCESS) {
+        printf("Module initialization failed: %d\n", handle.init_state);
+        module_handle_finalize(&handle);
+        return 1;
+    }
+
+    mod_log_write("work done");
+
+    printf("\n\n*** Exiting.\n");
+    module_quick_exit(&handle, 0);
+}
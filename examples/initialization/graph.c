@@ -0,0 +1,84 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program analyzes the IMPORT() graph of its modules, and lists
+ * the imports that other imports already imply.  With an argument, it
+ * also writes the graph to that file, as DOT if its name ends in
+ * '.dot', and as JSON otherwise.
+ */
+#include <stdio.h>
+
+#include "module_init_graph.h"
+
+int main(int argc, char *argv[])
+{
+    module_graph_report_t   report;
+    initialization_result_t result;
+
+    result = module_analyze_graph(&report);
+    switch (result) {
+    case IR_SUCCESS:
+        module_graph_report_print(&report, stdout);
+        break;
+
+    case IR_CYCLE:
+        printf("The imports form a cycle; see cycles_example.\n");
+        return 1;
+
+    case IR_MEMORY:
+        printf("Out of memory.\n");
+        return 1;
+
+    default:
+        return 1;
+    }
+
+    if (argc > 1) {
+        const size_t len = strlen(argv[1]);
+        FILE        *fp  = fopen(argv[1], "w");
+        int          failed;
+
+        if (fp == NULL) {
+            perror(argv[1]);
+            module_graph_report_free(&report);
+            return 1;
+        }
+        if (len > 4 && strcmp(argv[1] + len - 4, ".dot") == 0) {
+            failed = module_graph_write_dot(&report, fp);
+        } else {
+            failed = module_graph_write_json(&report, fp);
+        }
+        if (fclose(fp) != 0 || failed) {
+            printf("Unable to write '%s'.\n", argv[1]);
+        }
+    }
+
+    module_graph_report_free(&report);
+    return 0;
+}
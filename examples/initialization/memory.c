@@ -0,0 +1,63 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program initializes all modules, on one thread or, if a
+ * number of threads is given, in parallel, and reports the memory
+ * allocated by each initialization function together with its times.
+ *
+ * module_init_memory.h is included here, once for the program, so
+ * that the allocations of every module are seen.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "module_init_memory.h"
+#include "module_init_parallel.h"
+#include "module_init_timing.h"
+
+int main(int argc, char *argv[])
+{
+    module_init_handle_t handle;
+
+    if (argc > 1) {
+        module_initialization_parallel_with(&handle,
+                                            (unsigned)atoi(argv[1]),
+                                            MO_MEMORY);
+    } else {
+        module_initialization_with(&handle, MO_MEMORY);
+    }
+    if (handle.init_state == IR_SUCCESS || handle.init_state == IR_FAILED) {
+        module_finalization(&handle);
+    }
+
+    printf("\n");
+    module_timing_report(&handle, stdout);
+    module_handle_finalize(&handle);
+    return 0;
+}
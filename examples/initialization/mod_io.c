@@ -0,0 +1,167 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This module stands in for an I/O service shared by other modules:
+ * one thread that completes requests after a simulated device
+ * latency.  Requests that are outstanding at the same time overlap.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+#include "module_init.h"
+
+#define MOD_IO_MAX_REQUESTS 8
+
+typedef struct mod_io_request_t {
+    struct timespec   deadline;
+    void            (*done)(void *arg);
+    void             *arg;
+} mod_io_request_t;
+
+static pthread_mutex_t  mod_io_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   mod_io_cond;
+static pthread_t        mod_io_thread;
+static mod_io_request_t mod_io_requests[MOD_IO_MAX_REQUESTS];
+static unsigned         mod_io_n_requests;
+static int              mod_io_stop;
+
+
+static int
+mod_io_before(const struct timespec *a, const struct timespec *b)
+{
+    return (a->tv_sec < b->tv_sec ||
+            (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec));
+}
+
+
+static void *
+mod_io_main(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&mod_io_lock);
+    while (!mod_io_stop) {
+        struct timespec now;
+        unsigned        first = 0;
+        unsigned        i;
+
+        if (mod_io_n_requests == 0) {
+            pthread_cond_wait(&mod_io_cond, &mod_io_lock);
+            continue;
+        }
+
+        for (i = 1; i < mod_io_n_requests; ++i) {
+            if (mod_io_before(&mod_io_requests[i].deadline,
+                              &mod_io_requests[first].deadline)) {
+                first = i;
+            }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (mod_io_before(&now, &mod_io_requests[first].deadline)) {
+            pthread_cond_timedwait(&mod_io_cond, &mod_io_lock,
+                                   &mod_io_requests[first].deadline);
+        } else {
+            mod_io_request_t request = mod_io_requests[first];
+
+            --mod_io_n_requests;
+            mod_io_requests[first] = mod_io_requests[mod_io_n_requests];
+            pthread_mutex_unlock(&mod_io_lock);
+            request.done(request.arg);
+            pthread_mutex_lock(&mod_io_lock);
+        }
+    }
+    pthread_mutex_unlock(&mod_io_lock);
+    return NULL;
+}
+
+
+static int
+module_io_init(void)
+{
+    pthread_condattr_t attr;
+
+    printf("%s\n", __FUNCTION__);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&mod_io_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    return pthread_create(&mod_io_thread, NULL, mod_io_main, NULL);
+}
+
+
+static int
+module_io_fina(void)
+{
+    printf("%s\n", __FUNCTION__);
+    pthread_mutex_lock(&mod_io_lock);
+    mod_io_stop = 1;
+    pthread_cond_signal(&mod_io_cond);
+    pthread_mutex_unlock(&mod_io_lock);
+    pthread_join(mod_io_thread, NULL);
+    pthread_cond_destroy(&mod_io_cond);
+    return 0;
+}
+
+
+DECLARE_MODULE(mod_io, module_io_init, module_io_fina);
+
+
+/* mod_io_read
+ *
+ *   Calls 'done' with 'arg' on the I/O thread 'ms' milliseconds from
+ *   now.  Returns non-zero if too many requests are outstanding.
+ */
+int
+mod_io_read(unsigned ms, void (*done)(void *arg), void *arg)
+{
+    mod_io_request_t *request;
+
+    pthread_mutex_lock(&mod_io_lock);
+    if (mod_io_n_requests == MOD_IO_MAX_REQUESTS) {
+        pthread_mutex_unlock(&mod_io_lock);
+        return 1;
+    }
+
+    request = &mod_io_requests[mod_io_n_requests];
+    ++mod_io_n_requests;
+    clock_gettime(CLOCK_MONOTONIC, &request->deadline);
+    request->deadline.tv_sec  += ms / 1000;
+    request->deadline.tv_nsec += (long)(ms % 1000) * 1000000;
+    if (request->deadline.tv_nsec >= 1000000000) {
+        request->deadline.tv_sec  += 1;
+        request->deadline.tv_nsec -= 1000000000;
+    }
+    request->done = done;
+    request->arg  = arg;
+
+    pthread_cond_signal(&mod_io_cond);
+    pthread_mutex_unlock(&mod_io_lock);
+    return 0;
+}
@@ -0,0 +1,96 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This module builds a linked list of small nodes, and maps a buffer,
+ * so that its allocations can be seen with MO_MEMORY.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include "module_init.h"
+
+#define MOD_LIST_NODES  1000
+#define MOD_LIST_BUFFER (1024 * 1024)
+
+typedef struct mod_list_node_t {
+    struct mod_list_node_t *next;
+    unsigned                value;
+} mod_list_node_t;
+
+static mod_list_node_t *mod_list;
+static void            *mod_list_buffer;
+
+
+static int
+module_list_init(void)
+{
+    unsigned i;
+
+    for (i = 0; i < MOD_LIST_NODES; ++i) {
+        mod_list_node_t *node = malloc(sizeof(mod_list_node_t));
+
+        if (node == NULL) {
+            return 1;
+        }
+        node->next  = mod_list;
+        node->value = i;
+        mod_list    = node;
+    }
+
+    mod_list_buffer = mmap(NULL, MOD_LIST_BUFFER, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mod_list_buffer == MAP_FAILED) {
+        mod_list_buffer = NULL;
+        return 1;
+    }
+    printf("%s\n", __FUNCTION__);
+    return 0;
+}
+
+
+static int
+module_list_fina(void)
+{
+    while (mod_list != NULL) {
+        mod_list_node_t *next = mod_list->next;
+
+        free(mod_list);
+        mod_list = next;
+    }
+    if (mod_list_buffer != NULL) {
+        munmap(mod_list_buffer, MOD_LIST_BUFFER);
+    }
+    printf("%s\n", __FUNCTION__);
+    return 0;
+}
+
+
+DECLARE_MODULE(mod_list, module_list_init, module_list_fina,
+               .flags = MF_FINA_MEMORY);
+IMPORT(mod_list, mod_a)
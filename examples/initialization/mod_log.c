@@ -0,0 +1,78 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This module keeps a log in memory, and writes it out when it is
+ * finalized.  Its finalization function must run even when the
+ * program exits with module_quick_exit().
+ */
+#include <stdio.h>
+#include "module_init.h"
+
+#define MOD_LOG_LINES 16
+
+static const char *mod_log_lines[MOD_LOG_LINES];
+static unsigned    mod_log_count;
+
+
+void
+mod_log_write(const char *line)
+{
+    if (mod_log_count < MOD_LOG_LINES) {
+        mod_log_lines[mod_log_count] = line;
+        ++mod_log_count;
+    }
+}
+
+
+static int
+module_log_init(void)
+{
+    printf("%s\n", __FUNCTION__);
+    mod_log_write("log started");
+    return 0;
+}
+
+
+static int
+module_log_fina(void)
+{
+    unsigned i;
+
+    printf("%s: flushing %u lines\n", __FUNCTION__, mod_log_count);
+    for (i = 0; i < mod_log_count; ++i) {
+        printf("    log: %s\n", mod_log_lines[i]);
+    }
+    mod_log_count = 0;
+    return 0;
+}
+
+
+DECLARE_MODULE(mod_log, module_log_init, module_log_fina,
+               .flags = MF_FINA_AT_EXIT);
+IMPORT(mod_log, mod_a)
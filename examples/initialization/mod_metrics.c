@@ -0,0 +1,64 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This module shows the edges that do not require another module:
+ *
+ *   o It imports 'mod_trace' weakly: 'mod_trace' is initialized first
+ *     if it is linked into the program, but it is not required.
+ *
+ *   o It is ordered after 'mod_a', and after the lazy 'mod_lazy',
+ *     without importing them.  'mod_lazy' is not initialized on its
+ *     account.
+ */
+#include <stdio.h>
+#include "module_init.h"
+
+extern module_init_info_t MODULE_INIT(mod_trace) WEAK_;
+
+static int
+module_metrics_init(void)
+{
+    printf("%s: %s\n", __FUNCTION__,
+           &MODULE_INIT(mod_trace) != NULL ? "tracing" : "not tracing");
+    return 0;
+}
+
+
+static int
+module_metrics_fina(void)
+{
+    printf("%s\n", __FUNCTION__);
+    return 0;
+}
+
+
+DECLARE_MODULE(mod_metrics, module_metrics_init, module_metrics_fina);
+IMPORT_WEAK(mod_metrics, mod_trace)
+IMPORT_AFTER(mod_metrics, mod_a)
+IMPORT_AFTER(mod_metrics, mod_lazy)
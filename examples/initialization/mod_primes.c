@@ -0,0 +1,118 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This module builds a table of the primes below a limit, which is
+ * its only input.  The table is cacheable: when it has been cached by
+ * an earlier run, it is used directly from the cache file.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "module_init.h"
+
+#define MOD_PRIMES_LIMIT 4000000
+
+static const uint32_t *mod_primes;
+static size_t          mod_primes_count;
+static uint32_t       *mod_primes_built;
+
+
+static uint64_t
+module_primes_fingerprint(void)
+{
+    return MOD_PRIMES_LIMIT;
+}
+
+
+static int
+module_primes_build(module_blob_t *build)
+{
+    uint8_t *composite = calloc(MOD_PRIMES_LIMIT, 1);
+    size_t   n         = 0;
+    uint32_t i;
+
+    mod_primes_built = calloc(MOD_PRIMES_LIMIT / 2, sizeof(uint32_t));
+    if (composite == NULL || mod_primes_built == NULL) {
+        free(composite);
+        return 1;
+    }
+
+    for (i = 2; i < MOD_PRIMES_LIMIT; ++i) {
+        if (!composite[i]) {
+            uint64_t j;
+
+            mod_primes_built[n] = i;
+            ++n;
+            for (j = (uint64_t)i * i; j < MOD_PRIMES_LIMIT; j += i) {
+                composite[j] = 1;
+            }
+        }
+    }
+    free(composite);
+
+    mod_primes       = mod_primes_built;
+    mod_primes_count = n;
+    build->data      = mod_primes_built;
+    build->size      = n * sizeof(uint32_t);
+    return 0;
+}
+
+
+static int
+module_primes_cache(const module_blob_t *cached, module_blob_t *build)
+{
+    if (cached == NULL) {
+        printf("%s: building\n", __FUNCTION__);
+        return module_primes_build(build);
+    }
+
+    if (cached->size % sizeof(uint32_t) != 0) {
+        return 1;
+    }
+    printf("%s: using cached table\n", __FUNCTION__);
+    mod_primes       = cached->data;
+    mod_primes_count = cached->size / sizeof(uint32_t);
+    return 0;
+}
+
+
+static int
+module_primes_fina(void)
+{
+    printf("%s: %zu primes, largest %u\n", __FUNCTION__,
+           mod_primes_count,
+           mod_primes_count != 0 ? mod_primes[mod_primes_count - 1] : 0);
+    free(mod_primes_built);
+    return 0;
+}
+
+
+DECLARE_MODULE(mod_primes, NULL, module_primes_fina,
+               .cache_fn       = module_primes_cache,
+               .fingerprint_fn = module_primes_fingerprint);
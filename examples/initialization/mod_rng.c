@@ -0,0 +1,82 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This module holds the state of a random number generator.  A
+ * worker forked by a zygote must not produce the same numbers as its
+ * siblings, so the generator is reseeded in each child.
+ */
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include "module_init.h"
+
+unsigned rng_state;
+
+static void
+module_rng_seed(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    rng_state = ((unsigned)now.tv_nsec ^ (unsigned)getpid() * 2654435761u);
+    if (rng_state == 0) {
+        rng_state = 1;
+    }
+}
+
+
+static int
+module_rng_init(void)
+{
+    printf("%s\n", __FUNCTION__);
+    module_rng_seed();
+    return 0;
+}
+
+
+static int
+module_rng_prefork(void)
+{
+    printf("%s\n", __FUNCTION__);
+    return 0;
+}
+
+
+static int
+module_rng_postfork(void)
+{
+    module_rng_seed();
+    return 0;
+}
+
+
+DECLARE_MODULE(mod_rng, module_rng_init, NULL,
+               .prefork_fn  = module_rng_prefork,
+               .postfork_fn = module_rng_postfork);
+IMPORT(mod_rng, mod_a)
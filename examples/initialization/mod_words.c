@@ -0,0 +1,110 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This module builds a hash table of a million words.  The table and
+ * every word are allocated from the module's arena, so its
+ * finalization function frees nothing: the arena is released, with
+ * one munmap(2), when it returns.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "module_init.h"
+
+#define MOD_WORDS_COUNT   1000000
+#define MOD_WORDS_BUCKETS (1u << 20)
+
+typedef struct mod_word_t {
+    struct mod_word_t *next;
+    char               text[];
+} mod_word_t;
+
+mod_word_t **mod_words;
+unsigned     mod_words_count;
+
+
+unsigned
+mod_words_hash(const char *text)
+{
+    unsigned h = 2166136261u;
+
+    while (*text != '\0') {
+        h = (h ^ (unsigned char)*text) * 16777619u;
+        ++text;
+    }
+    return h & (MOD_WORDS_BUCKETS - 1);
+}
+
+
+static int
+module_words_init(void)
+{
+    unsigned i;
+
+    /* Memory from the arena is zero-filled, so all buckets are empty. */
+    mod_words = MODULE_ARENA_ALLOC(mod_words,
+                                   MOD_WORDS_BUCKETS * sizeof(mod_word_t *));
+    if (mod_words == NULL) {
+        return 1;
+    }
+
+    for (i = 0; i < MOD_WORDS_COUNT; ++i) {
+        char        text[32];
+        int         len = snprintf(text, sizeof(text), "word%u", i);
+        mod_word_t *w   = MODULE_ARENA_ALLOC(mod_words,
+                                             sizeof(mod_word_t) + len + 1);
+        unsigned    h;
+
+        if (w == NULL) {
+            return 1;
+        }
+        memcpy(w->text, text, len + 1);
+        h            = mod_words_hash(w->text);
+        w->next      = mod_words[h];
+        mod_words[h] = w;
+    }
+    mod_words_count = MOD_WORDS_COUNT;
+
+    printf("%s: %u words\n", __FUNCTION__, mod_words_count);
+    return 0;
+}
+
+
+static int
+module_words_fina(void)
+{
+    printf("%s: %u words\n", __FUNCTION__, mod_words_count);
+    mod_words       = NULL;
+    mod_words_count = 0;
+    return 0;
+}
+
+
+DECLARE_MODULE(mod_words, module_words_init, module_words_fina,
+               .arena_size = (size_t)1 << 30);
+IMPORT(mod_words, mod_a)
@@ -79,14 +79,22 @@ int main(void)
                        max_fname, ih->table[ih->table_index]->fina_fn_name);
 
                 {
-                    /* Print imported modules. */
-                    void *p = ih->table[ih->table_index]->imports.start;
-
-                    while (p < ih->table[ih->table_index]->imports.stop) {
-                        module_init_info_t *imp = *(module_init_info_t **)p;
-                        printf("%-*s  import: %-s\n",
-                               max_mname, " ", imp->module_name);
-                        p += sizeof(void *);
+                    /* Print imported modules, and the modules this one
+                     * is ordered after.
+                     */
+                    module_init_info_t *mip = ih->table[ih->table_index];
+                    unsigned            e;
+
+                    for (e = 0; e < module_n_edges(mip); ++e) {
+                        module_init_info_t *imp = module_edge(mip, e);
+
+                        if (imp != NULL) {
+                            printf("%-*s  %s: %-s\n",
+                                   max_mname, " ",
+                                   (e < module_n_imports(mip)
+                                    ? "import" : "after"),
+                                   imp->module_name);
+                        }
                     }
                 }
 
@@ -114,6 +122,18 @@ int main(void)
             printf("Module '%s' failed to initialized\n",
                    ih->table[ih->table_index]->module_name);
             break;
+
+        case IR_MEMORY:
+            printf("Error, unable to allocate the module table\n");
+            break;
+
+        case IR_PHASE:
+            printf("Error, module '%s' imports '%s' of a later phase\n",
+                   ih->table[0]->module_name, ih->table[1]->module_name);
+            break;
+
+        case IR_RELOAD:         /* Only returned by module_reload(). */
+            break;
         }
     }
 
@@ -0,0 +1,79 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program initializes the modules up to MP_SERVING, and starts
+ * a background thread to initialize 'mod_warmer'.  The main thread
+ * does not initialize 'mod_warmer' itself; it waits until the
+ * background thread has.
+ */
+#include <errno.h>
+#include <stdio.h>
+
+#include "module_init_parallel.h"
+
+int main(void)
+{
+    module_init_handle_t handle;
+    pthread_t            background;
+    int                  result;
+
+    printf("*** Initializing modules up to MP_SERVING.\n");
+    module_initialization_until(&handle, MP_SERVING);
+    if (handle.init_state != IR_SUCCESS) {
+        printf("Module initialization failed: %d\n", handle.init_state);
+        module_handle_finalize(&handle);
+        return 1;
+    }
+
+    printf("\n\n*** mod_server ready: %d, mod_warmer ready: %d\n",
+           MODULE_TRY_READY(mod_server), MODULE_TRY_READY(mod_warmer));
+
+    if (module_initialization_background(&handle, &background) != 0) {
+        printf("Unable to start the background thread.\n");
+        module_initialization_pending(&handle);
+        module_finalization(&handle);
+        module_handle_finalize(&handle);
+        return 1;
+    }
+
+    result = MODULE_WAIT_READY_FOR(mod_warmer, 10 * 1000 * 1000);
+    printf("*** Waiting 10 ms for mod_warmer: %s\n",
+           result == ETIMEDOUT ? "timed out" : "ready");
+
+    result = MODULE_WAIT_READY(mod_warmer);
+    printf("*** Waiting for mod_warmer: %s\n",
+           result == 0 ? "ready" : "canceled");
+
+    pthread_join(background, NULL);
+
+    printf("\n\n*** Finalizing modules.\n");
+    module_finalization(&handle);
+    module_handle_finalize(&handle);
+    return result;
+}
@@ -0,0 +1,74 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program initializes its modules, then replaces 'mod_greeter'
+ * with the one in mod_greeter_v2.so.  Only 'mod_greeter' and
+ * 'mod_app', which imports it, are finalized and initialized again.
+ */
+#include <dlfcn.h>
+#include <stdio.h>
+
+#include "module_init_reload.h"
+
+int main(int argc, char *argv[])
+{
+    const char              *path = "./mod_greeter_v2.so";
+    module_init_handle_t     handle;
+    initialization_result_t  result;
+    void                    *dso;
+
+    if (argc > 1) {
+        path = argv[1];
+    }
+
+    printf("*** Initializing modules.\n");
+    module_initialization(&handle);
+    if (handle.init_state != IR_SUCCESS) {
+        printf("Module initialization failed: %d\n", handle.init_state);
+        module_handle_finalize(&handle);
+        return 1;
+    }
+
+    printf("\n\n*** Replacing modules with those of '%s'.\n", path);
+    result = module_reload(&handle, path, &dso);
+    if (result == IR_RELOAD) {
+        printf("Unable to load '%s', or its modules do not match those "
+               "of the program.\n", path);
+    } else if (result != IR_SUCCESS) {
+        printf("Reload failed: %d\n", result);
+    }
+
+    printf("\n\n*** Finalizing modules.\n");
+    module_finalization(&handle);
+    module_handle_finalize(&handle);
+    if (dso != NULL) {
+        dlclose(dso);
+    }
+    return result != IR_SUCCESS;
+}
@@ -0,0 +1,82 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program initializes only the modules named on its command
+ * line, 'mod_e' and 'mod_j' by default, and the modules they import.
+ */
+#include <stdio.h>
+
+#include "module_init.h"
+
+int main(int argc, char *argv[])
+{
+    static const char   *default_roots[] = { "mod_e", "mod_j" };
+    module_init_info_t  *roots[16];
+    module_init_handle_t handle;
+    const char         **names   = default_roots;
+    unsigned             n_roots = 2;
+    unsigned             i;
+
+    if (argc > 1) {
+        names   = (const char **)&argv[1];
+        n_roots = (unsigned)argc - 1;
+    }
+    if (n_roots > sizeof(roots) / sizeof(roots[0])) {
+        printf("Too many modules.\n");
+        return 1;
+    }
+
+    for (i = 0; i < n_roots; ++i) {
+        roots[i] = module_find(names[i]);
+        if (roots[i] == NULL) {
+            printf("No module '%s'.\n", names[i]);
+            return 1;
+        }
+    }
+
+    printf("*** Initializing modules.\n");
+    module_initialization_roots(&handle, roots, n_roots);
+    if (handle.init_state != IR_SUCCESS) {
+        printf("Module initialization failed: %d\n", handle.init_state);
+        if (handle.init_state != IR_FAILED) {
+            module_handle_finalize(&handle);
+            return 1;
+        }
+    }
+
+    printf("\nInitialized:\n");
+    for (i = 0; i < handle.table_index; ++i) {
+        printf("  %s\n", handle.table[i]->module_name);
+    }
+
+    printf("\n\n*** Finalizing modules.\n");
+    module_finalization(&handle);
+    module_handle_finalize(&handle);
+    return 0;
+}
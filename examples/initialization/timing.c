@@ -0,0 +1,63 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program initializes and finalizes all modules while recording
+ * their times, and prints a report.  If a file name is given, the
+ * times are also written to it as a JSON trace-event file.
+ */
+#include <stdio.h>
+
+#include "module_init_timing.h"
+
+int main(int argc, char *argv[])
+{
+    module_init_handle_t handle;
+
+    module_initialization_with(&handle, MO_TIMING);
+    if (handle.init_state == IR_SUCCESS || handle.init_state == IR_FAILED) {
+        module_finalization(&handle);
+    }
+
+    printf("\n");
+    module_timing_report(&handle, stdout);
+
+    if (argc > 1) {
+        FILE *fp = fopen(argv[1], "w");
+
+        if (fp == NULL || module_timing_write_trace(&handle, fp) != 0) {
+            printf("Unable to write trace to '%s'.\n", argv[1]);
+        }
+        if (fp != NULL) {
+            fclose(fp);
+        }
+    }
+
+    module_handle_finalize(&handle);
+    return 0;
+}
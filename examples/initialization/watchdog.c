@@ -0,0 +1,62 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program initializes all modules under a watchdog.  'mod_slow'
+ * takes longer than its budget, so the watchdog reports it, with a
+ * backtrace of the thread that is initializing it.
+ */
+#include <stdio.h>
+#include <unistd.h>
+
+#include "module_init_watchdog.h"
+
+#define DEFAULT_BUDGET_MS 1000
+
+int main(void)
+{
+    module_init_handle_t handle;
+    module_watchdog_t    watchdog;
+
+    if (module_watchdog_start(&watchdog, DEFAULT_BUDGET_MS,
+                              STDERR_FILENO) != 0) {
+        printf("Unable to start the watchdog.\n");
+        return 1;
+    }
+    module_initialization(&handle);
+    module_watchdog_stop(&watchdog);
+
+    if (handle.init_state != IR_SUCCESS) {
+        printf("Module initialization failed: %d\n", handle.init_state);
+    }
+    if (handle.init_state == IR_SUCCESS || handle.init_state == IR_FAILED) {
+        module_finalization(&handle);
+    }
+    module_handle_finalize(&handle);
+    return 0;
+}
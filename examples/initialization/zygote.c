@@ -0,0 +1,138 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* This program is a zygote.  It initializes all modules once, then
+ * forks a worker for each request sent by its client.  Every worker
+ * starts with the modules initialized, and with 'mod_rng' reseeded.
+ *
+ * The client is forked before the modules are initialized; it does
+ * not use them.
+ */
+#include <stdio.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include "module_init_zygote.h"
+
+#define N_WORKERS 3
+
+extern unsigned rng_state;
+
+
+static int
+worker(void *arg, const void *request, size_t size)
+{
+    extern uint8_t MODULE_STATE(mod_rng);
+    int            id;
+
+    (void)arg;
+    if (size != sizeof(id)) {
+        return 1;
+    }
+    memcpy(&id, request, sizeof(id));
+
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    printf("worker %d: mod_rng %s, first number %u\n", id,
+           (MODULE_STATE(mod_rng) == IS_INITIALIZED
+            ? "initialized" : "not initialized"),
+           rng_state);
+    return 0;
+}
+
+
+static int
+client(int fd)
+{
+    int id;
+
+    for (id = 1; id <= N_WORKERS; ++id) {
+        struct timespec start;
+        struct timespec stop;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (module_zygote_spawn(fd, &id, sizeof(id)) < 0) {
+            perror("module_zygote_spawn");
+            return 1;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        printf("client: worker %d started in %.3f ms\n", id,
+               ((double)(stop.tv_sec - start.tv_sec) * 1e3 +
+                (double)(stop.tv_nsec - start.tv_nsec) / 1e6));
+    }
+    return 0;
+}
+
+
+int main(void)
+{
+    module_init_handle_t handle;
+    int                  sv[2];
+    int                  result;
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) != 0) {
+        perror("socketpair");
+        return 1;
+    }
+
+    fflush(NULL);
+    switch (fork()) {
+    case -1:
+        perror("fork");
+        return 1;
+
+    case 0:
+        close(sv[0]);
+        return client(sv[1]);
+
+    default:
+        close(sv[1]);
+        break;
+    }
+
+    printf("*** Initializing modules in the zygote.\n");
+    module_initialization(&handle);
+    if (handle.init_state != IR_SUCCESS) {
+        printf("Module initialization failed: %d\n", handle.init_state);
+        module_handle_finalize(&handle);
+        return 1;
+    }
+
+    printf("\n\n*** Serving requests.\n");
+    result = module_zygote_serve(&handle, sv[0], worker, NULL);
+    if (result != 0) {
+        perror("module_zygote_serve");
+    }
+
+    printf("\n\n*** Finalizing modules.\n");
+    module_finalization(&handle);
+    module_handle_finalize(&handle);
+    return result != 0;
+}
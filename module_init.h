@@ -37,7 +37,17 @@
 #define MODULE_INIT_H_
 
 #include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
 #include <malloc.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
 #include "linkerset.h"
 
 /* init_state_t
@@ -61,6 +71,11 @@
  *
  *     The module is fully initialized.  An attempt to initialize this
  *     module again is a NOP.
+ *
+ *   The state is published with a release store once the module's
+ *   initialization function has returned, so a thread that reads
+ *   IS_INITIALIZED with an acquire load also sees everything the
+ *   function did.  See module_set_state().
  */
 typedef enum init_state_t {
     IS_UNINITIALIZED,
@@ -69,6 +84,27 @@ typedef enum init_state_t {
 } init_state_t;
 
 
+/* MODULE_STATE_MASK, MODULE_MARK_VISITING, MODULE_MARK_SORTED,
+ * MODULE_MARK_NEEDED, MODULE_CANCELED
+ *
+ *  A module's state byte holds its init_state_t in the bits of
+ *  MODULE_STATE_MASK.  The other bits are marks that are set on
+ *  uninitialized modules, while module_init_lock is held, to sort
+ *  them; see topological_sort_module() and module_handle_closure().
+ *  They are never set on an initialized module, so the state byte of
+ *  an initialized module is exactly IS_INITIALIZED.
+ *
+ *  MODULE_CANCELED is not a mark: it is kept while the module is
+ *  sorted, and only cleared when the module's state is next
+ *  published.  See module_cancel().
+ */
+#define MODULE_STATE_MASK    0x03u
+#define MODULE_MARK_VISITING 0x04u /* On the stack of the sort. */
+#define MODULE_MARK_SORTED   0x08u /* In [0, table_index) of the sort. */
+#define MODULE_MARK_NEEDED   0x10u /* Kept by module_handle_closure(). */
+#define MODULE_CANCELED      0x20u /* Will not be initialized. */
+
+
 /* initialization_result_t
  *
  *  IR_SUCCESS: All modules have been initialized successfully.
@@ -79,16 +115,154 @@ typedef enum init_state_t {
  *             non-zero value to indicate it could not properly
  *             initialize.
  *
- *  IR_MEMORY: ADD COMMENT
+ *  IR_MEMORY: Memory for the table used to order the modules could
+ *             not be allocated, and no module has been initialized.
+ *             This cannot happen when the MO_STATIC_TABLE option is
+ *             used, unless MO_TIMING or MO_MEMORY is also used.
+ *
+ *  IR_PHASE:  A module imports a module of a later phase; see
+ *             module_phase_t.  No module has been initialized.
+ *
+ *  IR_RELOAD: A shared object could not be loaded by module_reload(),
+ *             or its modules cannot replace those of the program; see
+ *             module_init_reload.h.  No module has been changed.
  */
 typedef enum initialization_result_t {
     IR_SUCCESS,
     IR_CYCLE,
     IR_FAILED,
-    IR_MEMORY
+    IR_MEMORY,
+    IR_PHASE,
+    IR_RELOAD
 } initialization_result_t;
 
 
+/* module_init_option_t
+ *
+ *  Options that change how modules are initialized.  See
+ *  module_initialization_with().
+ *
+ *  MO_TIMING:
+ *
+ *    Record the wall-clock and CPU time of every initialization and
+ *    finalization function in the handle's 'timing' table.  See
+ *    module_init_timing.h for reports.
+ *
+ *  MO_STATIC_TABLE:
+ *
+ *    Order the modules in the 'module_init_table' section, which the
+ *    linker sizes to hold one pointer per module, instead of in
+ *    allocated memory.  No memory is allocated to initialize
+ *    modules, so this can be used before a program's allocator is
+ *    ready.  Only one handle at a time may use this option.  If the
+ *    linker has discarded the section, allocated memory is used.
+ *
+ *  MO_MEMORY:
+ *
+ *    As MO_TIMING, and also record the memory allocated by every
+ *    initialization function in the 'timing' table.  Allocations are
+ *    only seen by programs that include module_init_memory.h.
+ */
+typedef enum module_init_option_t {
+    MO_TIMING       = 1 << 0,
+    MO_STATIC_TABLE = 1 << 1,
+    MO_MEMORY       = 1 << 2
+} module_init_option_t;
+
+
+/* module_time_t
+ *
+ *  The time taken by one call of an initialization or finalization
+ *  function, in nanoseconds.
+ *
+ *  start_ns: When the call started, relative to the start of
+ *            initialization.
+ *
+ *  wall_ns:  The elapsed time of the call.
+ *
+ *  cpu_ns:   The CPU time used by the calling thread.
+ *
+ *  self_ns:  'wall_ns', less the time spent initializing other
+ *            modules on demand from within the call.
+ */
+typedef struct module_time_t {
+    uint64_t start_ns;
+    uint64_t wall_ns;
+    uint64_t cpu_ns;
+    uint64_t self_ns;
+} module_time_t;
+
+
+/* module_memory_t
+ *
+ *  The memory allocated by one call of an initialization function,
+ *  on the thread that made the call.  Memory allocated by modules
+ *  that the function initializes on demand is counted for those
+ *  modules, not for the caller.
+ *
+ *  bytes: The net number of bytes left allocated by the call.  It is
+ *         negative if the call freed more than it allocated.
+ *
+ *  count: The number of allocations, including reallocations and
+ *         mappings.
+ *
+ *  peak:  The largest net number of bytes allocated at any time
+ *         during the call.
+ */
+typedef struct module_memory_t {
+    int64_t  bytes;
+    uint64_t count;
+    int64_t  peak;
+} module_memory_t;
+
+
+/* module_timing_t
+ *
+ *  The time taken to initialize and finalize one module.  'thread'
+ *  identifies the thread that initialized it, and 'fina_thread' the
+ *  thread that finalized it; the calling thread is zero.  'memory' is
+ *  only recorded with MO_MEMORY.
+ */
+typedef struct module_timing_t {
+    module_time_t   init;
+    module_time_t   fina;
+    unsigned        thread;
+    unsigned        fina_thread;
+    module_memory_t memory;
+} module_timing_t;
+
+
+/* module_init_memory
+ *
+ *  The record of the module whose initialization function is running
+ *  on this thread with MO_MEMORY, or NULL.  module_init_memory.h
+ *  charges allocations to it.  Like module_init_lazy_handle, this is
+ *  a weak definition shared by all translation units.
+ */
+__thread module_memory_t *module_init_memory WEAK_;
+
+
+/* module_memory_charge
+ *
+ *   Adds 'bytes', which is negative for memory that is released, and
+ *   'count' allocations to the module being initialized on this
+ *   thread, if any.
+ */
+static inline void
+module_memory_charge(int64_t bytes, uint64_t count)
+{
+    module_memory_t *memory = module_init_memory;
+
+    if (memory != NULL) {
+        memory->bytes += bytes;
+        memory->count += count;
+        if (memory->bytes > memory->peak) {
+            memory->peak = memory->bytes;
+        }
+    }
+}
+
+
 /* module_init_fn_t:
  *
  *  This functions as the signature of the module initialization
@@ -105,310 +279,2875 @@ typedef int (*module_init_fn_t)(void);
 typedef int (*module_fina_fn_t)(void);
 
 
-/* module_import_info_t
+/* module_fork_fn_t:
  *
- *   This describes the [start, stop) of the linkerset containing the
- *   imports of a module.  This is used to process the initialization
- *   functions of imported modules.
+ *  The signature of the hooks a module may have around fork(2); see
+ *  module_init_zygote.h.  Zero is success.
+ */
+typedef int (*module_fork_fn_t)(void);
+
+
+/* module_completion_t, module_async_init_fn_t, MODULE_INIT_PENDING
+ *
+ *  An asynchronous initialization function, set with the
+ *  'async_init_fn' field in DECLARE_MODULE, is used instead of an
+ *  initialization function by modules that mostly wait, for example
+ *  on I/O.  It either returns its result immediately, as an
+ *  initialization function does, or starts its work and returns
+ *  MODULE_INIT_PENDING.  In the latter case, the work must later call
+ *  module_init_complete(), exactly once, with 'completion' and the
+ *  result; it may do so from any thread, even before the function
+ *  returns, but not from a signal handler, because the engine may
+ *  take a lock.
+ *
+ *  The modules that import a pending module are not initialized
+ *  until it completes.  module_initialization_parallel() starts other
+ *  modules meanwhile, even with a single worker, so the waits
+ *  overlap without a thread per module; module_initialization()
+ *  waits for each one in turn.
  *
- *   There will be one linkerset of imports for each module contained
- *   in the program.
+ *  The module_completion_t belongs to the initialization engine; it
+ *  must not be used after module_init_complete() is called.
  */
-typedef struct module_import_info_t {
-    void *start;
-    void *stop;
-} module_import_info_t;
+#define MODULE_INIT_PENDING INT_MIN
 
+typedef struct module_completion_t module_completion_t;
 
-/* module_init_info_t
+typedef int (*module_async_init_fn_t)(module_completion_t *completion);
+
+
+/* module_blob_t, module_cache_fn_t, module_fingerprint_fn_t
  *
- *  This linkerset describes the modules declared in the program.  It
- *  is used to fully initialize all declared modules.
+ *  A cacheable module, with a 'cache_fn' set in DECLARE_MODULE, is
+ *  initialized from a blob of data that only depends on the program
+ *  and on inputs identified by the result of its 'fingerprint_fn'.
+ *  When the program has a cache (see module_init_cache.h), the blob
+ *  is kept between runs, and is not recomputed.
+ *
+ *  'cache_fn' is used instead of an initialization function.  It is
+ *  called in one of two ways:
+ *
+ *    o 'cached' is not NULL.  The module is initialized from the
+ *      read-only blob it describes, which remains valid until the
+ *      cache is closed.  If it returns non-zero, the blob is
+ *      considered invalid, and it is called again to build one.
+ *
+ *    o 'cached' is NULL.  The module is initialized by computing its
+ *      data; the blob to be cached is returned in 'build', which
+ *      still belongs to the module.  A NULL 'build->data' is not
+ *      cached.
+ *
+ *  'fingerprint_fn' may be NULL if the blob depends only on the
+ *  program.
  */
-typedef struct module_init_info_t {
-    const char           *module_name;
-    module_import_info_t  imports;
-    module_init_fn_t      init_fn;
-    const char           *init_fn_name;
-    module_fina_fn_t      fina_fn;
-    const char           *fina_fn_name;
-    init_state_t          init_state;
-} module_init_info_t;
+typedef struct module_blob_t {
+    const void *data;
+    size_t      size;
+} module_blob_t;
 
+typedef int (*module_cache_fn_t)(const module_blob_t *cached,
+                                 module_blob_t       *build);
 
-/* module_import_t
+typedef uint64_t (*module_fingerprint_fn_t)(void);
+
+
+/* module_flags_t
  *
- *   This type is a linkerset that is used to collate imports of a
- *   module into a single data structure.
+ *  Optional properties of a module, set with the 'flags' field in
+ *  DECLARE_MODULE.
  *
- *   Because linkersets are name-based, this type is not used
- *   directly; instead a module-specific alias is created in
- *   DECLARE_MODULE so that each importing module's linkerset of
- *   imports will be unique.
+ *  MF_LAZY:
  *
- *   The MODULE_IMPORT macro is used to produce the name of the alias.
+ *    The module is not initialized by module_initialization() unless
+ *    it is (transitively) imported by a module that is not lazy.
+ *    Instead, it is initialized, together with its imports, the
+ *    first time MODULE_ENSURE_INITIALIZED() is used for it.
+ *
+ *  MF_FINA_AT_EXIT:
+ *
+ *    The module's finalization function has effects that outlive the
+ *    process, such as flushing a log, so module_quick_exit() calls
+ *    it.  A finalization function without MF_FINA_MEMORY is treated
+ *    the same way; this flag records that it was decided.
+ *
+ *  MF_FINA_MEMORY:
+ *
+ *    The module's finalization function only releases memory, or
+ *    other resources the kernel reclaims when the process exits, so
+ *    module_quick_exit() does not call it.
+ *
+ *  See module_init_exit.h.
  */
-typedef struct module_import_t {
-    module_init_info_t *importee_init;
-} module_import_t;
+typedef enum module_flags_t {
+    MF_LAZY         = 1 << 0,
+    MF_FINA_AT_EXIT = 1 << 1,
+    MF_FINA_MEMORY  = 1 << 2
+} module_flags_t;
 
 
-/* module_init_info
+/* module_phase_t
  *
- *  This linkerset is used to hold the initialization information for
- *  all declared modules.
+ *  The phase, or run level, of a module, set with the 'phase' field
+ *  in DECLARE_MODULE.  Modules are initialized phase by phase, so a
+ *  program can stop after the phase that makes it ready to work, and
+ *  finish the later phases in the background; see
+ *  module_initialization_until().
+ *
+ *  A module may only depend on modules of its own phase or an earlier
+ *  one: an IMPORT(), or IMPORT_AFTER(), of a module of a later phase
+ *  is an error, IR_PHASE.
+ *
+ *  MP_EARLY:      The default.
+ *  MP_CORE:       Modules most of the program needs.
+ *  MP_SERVING:    The last modules needed before work is accepted.
+ *  MP_BACKGROUND: Modules that need not delay work, such as cache
+ *                 warmers and metrics exporters.
  */
-LINKERSET_DECLARE(module_init_info);
+typedef enum module_phase_t {
+    MP_EARLY,
+    MP_CORE,
+    MP_SERVING,
+    MP_BACKGROUND
+} module_phase_t;
 
 
-/* MODULE_IMPORT
+/* module_import_info_t
  *
- *  This macro produces an alias name for module_import_t so that each
- *  module's import list will be kept in a unique linkerset.
+ *   This describes the [start, stop) of the linkerset containing the
+ *   imports of a module.  This is used to process the initialization
+ *   functions of imported modules.
+ *
+ *   There will be one linkerset of imports, and one of ordering-only
+ *   edges, for each module contained in the program.  An element is
+ *   NULL if it refers, weakly, to a module that is not linked into the
+ *   program; see IMPORT_WEAK() and IMPORT_AFTER().
  */
-#define MODULE_IMPORT(mname_) XCONCAT_(mname_,_import_info)
+typedef struct module_import_info_t {
+    void *start;
+    void *stop;
+} module_import_info_t;
 
 
-/* MODULE_INIT
+/* MODULE_INIT_EDGE_TABLE
  *
- *  This macro produces the name of the module-unique variable that
- *  holds the initialization information that is put into the
- *  'module_init_info' linkerset.
+ *   Define MODULE_INIT_EDGE_TABLE, when compiling every object of a
+ *   program, to keep the edges of all modules in one table, instead
+ *   of in two linkersets per module.
+ *
+ *   IMPORT(), IMPORT_WEAK() and IMPORT_AFTER() then add an
+ *   (importer, importee) record to the single 'module_init_edge'
+ *   linkerset, and reserve one slot in the 'module_init_csr' section.
+ *   The first time the edges of a module are needed, the slots are
+ *   filled with the importees, grouped by importer, so the edges of
+ *   each module are contiguous; see module_edge_table_build().  A
+ *   program of thousands of modules then has three sections for its
+ *   edges, rather than thousands, and sorting the modules reads their
+ *   edges from one dense array.
  */
-#define MODULE_INIT(mname_) XCONCAT_(mname_,_init_)
 
 
-/* DECLARE_MODULE
+/* module_init_info_t
  *
- *  This macro declares a module, and sets up all the necessary
- *  internal state to maintain its initialization information.
+ *  This linkerset describes the modules declared in the program.  It
+ *  is used to fully initialize all declared modules.
  *
- *  NOTE:
+ *  The type is const: DECLARE_MODULE places the descriptors in
+ *  read-only data, so they stay shared between processes.  What
+ *  changes while modules are initialized is kept outside of them.
  *
- *    Declaring two modules with the same name is results in undefined
- *    behavior.
+ *  state:
  *
- *    Using NULL as the value of init_fn_ results in declaring a
- *    module with no initialization function.
+ *    The module's init_state_t, stored as one byte in the
+ *    'module_init_state' section.  That section is a dense array with
+ *    one byte per module.  It is only accessed atomically; see
+ *    module_state().
+ *
+ *  ordinal:
+ *
+ *    The index of the module in the 'table' of the
+ *    module_init_handle_t that sorted it, stored in the
+ *    'module_init_ordinal' section.  This is only valid after the
+ *    module has been topologically sorted, and it is used to index
+ *    per-module data kept outside of the module information.
+ *
+ *  impl:
+ *
+ *    The replacement of the module loaded by module_reload(), stored
+ *    in the 'module_init_impl' section, or NULL.  Its functions are
+ *    called instead of the module's; see module_impl().
+ *
+ *  imports, after:
+ *
+ *    The modules that must be initialized before this one, and the
+ *    modules that are only ordered before it; see IMPORT() and
+ *    IMPORT_AFTER().
+ *
+ *  edges:
+ *
+ *    Replaces 'imports' and 'after' when MODULE_INIT_EDGE_TABLE is
+ *    defined.
+ *
+ *  flags:
+ *
+ *    A bitwise-or of module_flags_t values.
+ *
+ *  async_init_fn:
+ *
+ *    If not NULL, the asynchronous initialization function of the
+ *    module, which is used instead of 'init_fn'.
+ *
+ *  cache_fn, fingerprint_fn:
+ *
+ *    If 'cache_fn' is not NULL, the module is cacheable, and it is
+ *    used instead of 'init_fn' and 'async_init_fn'.
+ *
+ *  budget_ms:
+ *
+ *    The time, in milliseconds, the module's initialization function
+ *    is expected to take at most, or zero for the default of the
+ *    watchdog (see module_init_watchdog.h).
+ *
+ *  phase:
+ *
+ *    The module's module_phase_t.
+ *
+ *  prefork_fn, postfork_fn:
+ *
+ *    If not NULL, called by module_fork() in the parent just before
+ *    fork(2), and in the child just after it; see
+ *    module_init_zygote.h.
+ *
+ *  arena, arena_size:
+ *
+ *    If 'arena_size' is not zero, the module has an arena of that
+ *    many bytes, from which it allocates with module_arena_alloc().
+ *    'arena' is its state.
  */
-#define DECLARE_MODULE(mname_, init_fn_, fina_fn_)                      \
-    typedef module_import_t XCONCAT_(MODULE_IMPORT(mname_),_t);         \
-    LINKERSET_DECLARE(MODULE_IMPORT(mname_));                           \
-    extern int XCONCAT_(mname_,_init_fn)(void);                         \
-    module_init_info_t MODULE_INIT(mname_) = {                          \
-        .module_name = XSTRING_(mname_),                                \
-        .init_fn       = init_fn_,                                      \
-        .init_fn_name  = XSTRING_(init_fn_),                            \
-        .fina_fn       = fina_fn_,                                      \
-        .fina_fn_name  = XSTRING_(fina_fn_),                            \
-        .imports.start = LINKERSET_START(MODULE_IMPORT(mname_)),        \
-        .imports.stop  = LINKERSET_STOP(MODULE_IMPORT(mname_)),         \
-        .init_state    = IS_UNINITIALIZED                               \
-    };                                                                  \
-    LINKERSET_ADD_ITEM(module_init_info, XCONCAT_(mname_, _init_))
+typedef const struct module_init_info_t module_init_info_t;
 
 
-/* IMPORT
+/* module_edges_t
  *
- *   This macro adds an imported module to the set of imports for the
- *   importer.
+ *   The edges of a module in the adjacency array built from the
+ *   'module_init_edge' linkerset, when MODULE_INIT_EDGE_TABLE is
+ *   defined: its 'n_imports' imports, followed by its ordering-only
+ *   edges, 'n_edges' in all, from 'start'.  It is stored in the
+ *   'module_init_edges' section.
  */
-#define IMPORT(importer_, importee_)                                    \
-    extern module_init_info_t MODULE_INIT(importee_);                   \
-    LINKERSET_ADD_ITEM(MODULE_IMPORT(importer_), MODULE_INIT(importee_));
+typedef struct module_edges_t {
+    module_init_info_t **start;
+    unsigned             n_imports;
+    unsigned             n_edges;
+} module_edges_t;
 
 
-/* init_handle_t
+/* module_arena_t
  *
+ *   The arena of a module, stored in the 'module_init_arena' section:
+ *   'base' is its mapping, or NULL until the first allocation, and
+ *   'used' the number of bytes allocated from it.  See
+ *   module_arena_alloc().
  */
-typedef struct module_init_handle_t {
-    /* init_state:
-     *
-     *   The state of initialization at the end of the function
-     *   receiving this type asd an argument.
-     *
-     * table_index:
-     *
-     *   This field is used to index the 'table' field.  When the
-     *   entire table has been successfully processed, its value can
-     *   be one larger than the last valid index into the table.
-     *
-     *   inv: 0 <= table_index <= table_size
-     *
-     * table_size:
-     *
-     *   This is the number of elements allocated for 'table'.
-     *
-     * table:
-     *
-     *   This field is used to topologically sort the set of modules
-     *   into an order suitable for sequential initialization.  If the
-     *   set of modules cannot be put into an order for sequential
-     *   initialization, no modules will be initialized, and
-     *   'init_state' will not be set to IR_SUCCESS.
-     *
-     *   inv:
-     *     (Ai: 0 <= i < table_index: table[i] is valid 'module_init_info_t *') &&
-     *     (Ai: table_index <= i < table_size: table[i] is undefined)
-     */
-    initialization_result_t    init_state;
-    unsigned                   table_index;
-    unsigned                   table_size;
-    module_init_info_t       **table;
-} module_init_handle_t;
+typedef struct module_arena_t {
+    char   *base;
+    size_t  used;
+} module_arena_t;
 
 
-static inline void
-module_handle_initialize(module_init_handle_t *ih, unsigned table_size)
-{
-    ih->init_state  = IR_SUCCESS;
-    ih->table_size  = table_size;
-    ih->table       = 0;
-    ih->table_index = 0;
-    if (table_size != 0) {
-        ih->table = calloc(ih->table_size, sizeof(module_init_info_t *));
-    }
-}
+struct module_init_info_t {
+    const char             *module_name;
+#if defined(MODULE_INIT_EDGE_TABLE)
+    module_edges_t         *edges;
+#else
+    module_import_info_t    imports;
+    module_import_info_t    after;
+#endif
+    module_init_fn_t        init_fn;
+    const char             *init_fn_name;
+    module_fina_fn_t        fina_fn;
+    const char             *fina_fn_name;
+    uint8_t                *state;
+    unsigned               *ordinal;
+    module_init_info_t    **impl;
+    module_arena_t         *arena;
+    unsigned                flags;
+    module_async_init_fn_t  async_init_fn;
+    module_cache_fn_t       cache_fn;
+    module_fingerprint_fn_t fingerprint_fn;
+    unsigned                budget_ms;
+    module_phase_t          phase;
+    module_fork_fn_t        prefork_fn;
+    module_fork_fn_t        postfork_fn;
+    size_t                  arena_size;
+};
 
 
-/* module_handle_finalize
- *
- *  Frees dynamically allocated resources, and resets the state of the
- *  handler so that subsequent usage will not cause a invalid memory
- *  reference.
+/* module_impl
  *
- *  This must be called by a client of this library when use of the
- *  module initialization / finalization system is done.
+ *   Returns the descriptor whose functions implement 'mip': its
+ *   replacement, if module_reload() has replaced it, and otherwise
+ *   'mip' itself.  module_init_lock must be held, or 'mip' must be
+ *   initialized.
  */
-static inline void
-module_handle_finalize(module_init_handle_t *ih)
+static inline module_init_info_t *
+module_impl(module_init_info_t *mip)
 {
-    free(ih->table);
-    module_handle_initialize(ih, 0);
+    return (mip->impl != NULL && *mip->impl != NULL) ? *mip->impl : mip;
 }
 
 
-/* topological_sort_modules
+/* module_has_init
  *
- *   This function performs the administrative work around invoking
- *   the initialization function of all imported modules, and the
- *   current module.
+ *   Returns non-zero if 'mip' has any kind of initialization function.
  */
-static inline void
-topological_sort_module(module_init_handle_t *ih,
-                        module_init_info_t   *mip)
-{
-    if (mip->init_state == IS_INITIALIZING) {
-        /* Cycle detected. Store offending module in cycle table. */
-        ih->init_state  = IR_CYCLE;
-        ih->table[0]    = mip;
-        ih->table_index = 1;
-    } else if (mip->init_state == IS_UNINITIALIZED) {
-        /* Follow imported modules, depth first. */
-
-        initialization_result_t  res;
-        void                    *p = mip->imports.start;
-
-        mip->init_state = IS_INITIALIZING; /* For cycle detection. */
-        while (p < mip->imports.stop) {
-            module_init_info_t *impp = *(module_init_info_t **)p;
-            topological_sort_module(ih, impp);
-            if (ih->init_state == IR_CYCLE) {
-                ih->table[ih->table_index] = mip;
-                ih->table_index++;
-                return;
-            } else if (ih->init_state != IR_SUCCESS) {
-                return;
-            }
-            p += sizeof(void *);
-        }
-
-        /* mip is a module that is clear to be initialized. */
-        ih->table[ih->table_index] = mip;
-        ++ih->table_index;
-        mip->init_state = IS_INITIALIZED;
-    } else {
-        assert(mip->init_state == IS_INITIALIZED);
-    }
+static inline int
+module_has_init(module_init_info_t *mip)
+{
+    mip = module_impl(mip);
+    return (mip->init_fn != NULL ||
+            mip->async_init_fn != NULL ||
+            mip->cache_fn != NULL);
 }
 
 
-static inline void
-topological_sort_modules(module_init_handle_t *ih)
-{
-    LINKERSET_ITERATE(module_init_info, mi, {
-            topological_sort_module(ih, mi);
-            if (ih->init_state != IR_SUCCESS) {
-                return;
-            }
-        });
-    assert(ih->table_index == ih->table_size);
-}
+/* MODULE_ARENA_ALIGN
+ *
+ *   The alignment of every allocation from a module's arena.
+ */
+#define MODULE_ARENA_ALIGN _Alignof(max_align_t)
 
 
-/* module_initialization
+/* module_arena_alloc
  *
- *   This function processes the module_init_info linkerset, invoking
- *   the initialization functions of all declared modules.
+ *   Allocates 'size' bytes, aligned for any type, from the arena of
+ *   'mip', and returns them.  NULL is returned if 'mip' has no arena,
+ *   or too little of it is left.  The memory is zero-filled.  It may
+ *   be called from any thread.
  *
- *   If the result is not IR_SUCCESS, then it indicates the type of
- *   error encountered, and 'module_err' will refer to the module at
- *   which the error occured.
+ *   The first allocation maps the whole arena, 'arena_size' bytes,
+ *   with one mmap(2); its pages are only backed by memory once they
+ *   are used.  Allocations are not freed one by one: the arena is
+ *   unmapped after the module's finalization function returns, or if
+ *   its initialization function fails.  See module_arena_release().
  *
- * XXX fix this comment.  Describe errors.
- *   If the result is IR_SUCCESS, the contents of 'module_err' are
- *   undefined.
+ *   With MO_MEMORY, each allocation is charged to the module being
+ *   initialized, as malloc() is; the mapping itself is not.
  */
-static inline void
-module_initialization(module_init_handle_t *ih)
+static inline void *
+module_arena_alloc(module_init_info_t *mip, size_t size)
 {
-    module_handle_initialize(ih, LINKERSET_SIZE(module_init_info, unsigned));
+    module_arena_t  *arena = mip->arena;
+    module_memory_t *saved_memory;
+    char            *base;
+    size_t           used;
 
-    if (ih->table == NULL) {
-        ih->init_state = IR_MEMORY;
-        return;
+    if (arena == NULL || size > mip->arena_size) {
+        return NULL;
     }
 
-    topological_sort_modules(ih);
+    base = __atomic_load_n(&arena->base, __ATOMIC_ACQUIRE);
+    if (base == NULL) {
+        char *map;
 
-    /* ih->table now contains a set of modules that is in an order
-     * suitable for sequential initialization.
-     *
-     * The original linkerset is unchanged.
-     */
-    ih->table_index = 0;
-    while (ih->table_index < ih->table_size) {
-        if (ih->table[ih->table_index]->init_fn != NULL) {
-            int init_result;
+        /* module_init_memory.h would charge the whole reservation. */
+        saved_memory       = module_init_memory;
+        module_init_memory = NULL;
+        map = mmap(NULL, mip->arena_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        module_init_memory = saved_memory;
 
-            ih->table[ih->table_index]->init_state = IS_INITIALIZING;
-            init_result= ih->table[ih->table_index]->init_fn();
-            if (init_result != 0) {
-                ih->init_state = IR_FAILED;
-                return;
+        if (map == MAP_FAILED) {
+            return NULL;
+        }
+        if (__atomic_compare_exchange_n(&arena->base, &base, map, 0,
+                                        __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE)) {
+            base = map;
+        } else {
+            /* Another thread mapped it first; 'base' is its mapping. */
+            module_init_memory = NULL;
+            munmap(map, mip->arena_size);
+            module_init_memory = saved_memory;
+        }
+    }
+
+    size = (size + MODULE_ARENA_ALIGN - 1) & ~(MODULE_ARENA_ALIGN - 1);
+    used = __atomic_load_n(&arena->used, __ATOMIC_RELAXED);
+    do {
+        if (size > mip->arena_size - used) {
+            return NULL;
+        }
+    } while (!__atomic_compare_exchange_n(&arena->used, &used, used + size,
+                                          1, __ATOMIC_RELAXED,
+                                          __ATOMIC_RELAXED));
+    module_memory_charge((int64_t)size, 1);
+    return base + used;
+}
+
+
+/* MODULE_ARENA_ALLOC
+ *
+ *   module_arena_alloc() from the arena of the module 'mname_'.
+ */
+#define MODULE_ARENA_ALLOC(mname_, size_)                               \
+    ({                                                                  \
+        extern MODULE_VISIBILITY_ module_init_info_t MODULE_INIT(mname_); \
+        module_arena_alloc(&MODULE_INIT(mname_), (size_));              \
+    })
+
+
+/* module_arena_release
+ *
+ *   Unmaps the arena of 'mip', if it is mapped, releasing everything
+ *   allocated from it at once.  It is called when 'mip' is finalized,
+ *   or its initialization fails, so it is called with the descriptor
+ *   whose functions were called; see module_impl().  Like the
+ *   mapping, the unmapping is not charged with MO_MEMORY.
+ */
+static inline void
+module_arena_release(module_init_info_t *mip)
+{
+    module_arena_t  *arena        = mip->arena;
+    module_memory_t *saved_memory = module_init_memory;
+
+    if (arena == NULL || arena->base == NULL) {
+        return;
+    }
+    module_init_memory = NULL;
+    munmap(arena->base, mip->arena_size);
+    module_init_memory = saved_memory;
+    arena->base = NULL;
+    arena->used = 0;
+}
+
+
+/* module_n_imports, module_n_edges, module_edge
+ *
+ *   The edges of a module are its imports, followed by its
+ *   ordering-only edges.  module_edge() returns the module at the end
+ *   of the 'i'th edge of 'mip', which is NULL for a weak edge to a
+ *   module that is not linked into the program.
+ */
+#if defined(MODULE_INIT_EDGE_TABLE)
+static inline void
+module_edge_table_build(void);
+
+static inline const module_edges_t *
+module_edges(const module_init_info_t *mip);
+
+
+static inline unsigned
+module_n_imports(const module_init_info_t *mip)
+{
+    return module_edges(mip)->n_imports;
+}
+
+
+static inline unsigned
+module_n_edges(const module_init_info_t *mip)
+{
+    return module_edges(mip)->n_edges;
+}
+
+
+static inline module_init_info_t *
+module_edge(const module_init_info_t *mip, unsigned i)
+{
+    return module_edges(mip)->start[i];
+}
+#else
+static inline unsigned
+module_n_imports(const module_init_info_t *mip)
+{
+    return (unsigned)((module_init_info_t **)mip->imports.stop -
+                      (module_init_info_t **)mip->imports.start);
+}
+
+
+static inline unsigned
+module_n_edges(const module_init_info_t *mip)
+{
+    return (module_n_imports(mip) +
+            (unsigned)((module_init_info_t **)mip->after.stop -
+                       (module_init_info_t **)mip->after.start));
+}
+
+
+static inline module_init_info_t *
+module_edge(const module_init_info_t *mip, unsigned i)
+{
+    const unsigned n_imp = module_n_imports(mip);
+
+    if (i < n_imp) {
+        return ((module_init_info_t **)mip->imports.start)[i];
+    }
+    return ((module_init_info_t **)mip->after.start)[i - n_imp];
+}
+#endif
+
+
+/* module_cache_t
+ *
+ *  The interface of a cache of the blobs of cacheable modules.
+ *
+ *  load:  Finds the blob of 'mip' for its current fingerprint, and
+ *         returns zero if it was found.
+ *
+ *  store: Saves the blob built by 'mip'.  Failure is not reported;
+ *         the blob is built again on the next run.
+ *
+ *  Both may be called concurrently by parallel initialization.
+ */
+typedef struct module_cache_t module_cache_t;
+
+struct module_cache_t {
+    int  (*load)(module_cache_t     *cache,
+                 module_init_info_t *mip,
+                 uint64_t            fingerprint,
+                 module_blob_t      *blob);
+    void (*store)(module_cache_t      *cache,
+                  module_init_info_t  *mip,
+                  uint64_t             fingerprint,
+                  const module_blob_t *blob);
+};
+
+
+/* module_init_cache
+ *
+ *  The cache used to initialize cacheable modules, or NULL.  Like
+ *  module_init_lazy_handle, this is a weak definition shared by all
+ *  translation units.
+ */
+module_cache_t *module_init_cache WEAK_;
+
+
+/* module_watch_t
+ *
+ *  The interface of an observer of initialization functions, such as
+ *  the watchdog of module_init_watchdog.h.
+ *
+ *  begin: Called on the initializing thread just before the
+ *         initialization function of 'mip' is called.
+ *
+ *  end:   Called on the same thread when it has returned.
+ *
+ *  Calls nest when a module is initialized on demand from within
+ *  another's initialization function.
+ *
+ *  An asynchronous initialization function is watched until it
+ *  returns.  When module_initialization_parallel() leaves it pending,
+ *  no thread runs it, so the time until it completes is not watched.
+ */
+typedef struct module_watch_t module_watch_t;
+
+struct module_watch_t {
+    void (*begin)(module_watch_t *watch, module_init_info_t *mip);
+    void (*end)(module_watch_t *watch, module_init_info_t *mip);
+};
+
+
+/* module_init_watch
+ *
+ *  The observer of initialization functions, or NULL.  Like
+ *  module_init_cache, this is a weak definition shared by all
+ *  translation units.
+ */
+module_watch_t *module_init_watch WEAK_;
+
+
+/* module_profile_t
+ *
+ *  The interface of a profile of the time taken by initialization
+ *  functions on earlier runs, such as the one of
+ *  module_init_profile.h.
+ *
+ *  cost: Returns the expected time, in nanoseconds, of the
+ *        initialization function of 'mip'.
+ */
+typedef struct module_profile_t module_profile_t;
+
+struct module_profile_t {
+    uint64_t (*cost)(module_profile_t *profile, module_init_info_t *mip);
+};
+
+
+/* module_init_profile
+ *
+ *  The profile used by module_initialization_parallel() to start the
+ *  modules on the critical path first, or NULL.  Like
+ *  module_init_cache, this is a weak definition shared by all
+ *  translation units.
+ */
+module_profile_t *module_init_profile WEAK_;
+
+
+/* module_completion_t
+ *
+ *  module:   The module being initialized.
+ *
+ *  complete: Called by module_init_complete(); it is set by the
+ *            engine that started the module.
+ *
+ *  time:     Where the time of the call is recorded, or NULL.
+ *
+ *  The other fields are private to the engine.
+ */
+struct module_completion_t {
+    module_init_info_t  *module;
+    void               (*complete)(module_completion_t *completion,
+                                   int                  result);
+    module_time_t       *time;
+    void                *engine;
+    uint64_t             start_ns;
+    int                  result;
+    uint32_t             done;
+};
+
+
+/* module_init_complete
+ *
+ *   Reports the 'result' of the asynchronous initialization function
+ *   that returned MODULE_INIT_PENDING for 'completion'.  Zero is
+ *   success.
+ */
+static inline void
+module_init_complete(module_completion_t *completion, int result)
+{
+    completion->complete(completion, result);
+}
+
+
+/* module_import_t
+ *
+ *   This type is a linkerset that is used to collate imports of a
+ *   module into a single data structure.
+ *
+ *   Because linkersets are name-based, this type is not used
+ *   directly; instead a module-specific alias is created in
+ *   DECLARE_MODULE so that each importing module's linkerset of
+ *   imports will be unique.
+ *
+ *   The MODULE_IMPORT macro is used to produce the name of the alias.
+ */
+typedef struct module_import_t {
+    module_init_info_t *importee_init;
+} module_import_t;
+
+
+/* module_init_info
+ *
+ *  This linkerset is used to hold the initialization information for
+ *  all declared modules.
+ */
+LINKERSET_DECLARE(module_init_info);
+
+
+#if defined(MODULE_INIT_DSO)
+/* module_dso_modules
+ *
+ *   Returns the modules declared in the shared object, and their
+ *   number in '*n_modules'.  module_reload() finds it with dlsym(3).
+ */
+__attribute__((weak, visibility("default"))) module_init_info_t **
+module_dso_modules(unsigned *n_modules)
+{
+#if defined(MODULE_INIT_EDGE_TABLE)
+    /* The edges of the shared object's modules are in its own table,
+     * which the program's module_edges() does not build.
+     */
+    module_edge_table_build();
+#endif
+    *n_modules = LINKERSET_SIZE(module_init_info, unsigned);
+    return LINKERSET_START(module_init_info);
+}
+#endif
+
+
+/* module_init_table
+ *
+ *  This section has one slot, initially NULL, for each declared
+ *  module.  It is not a linkerset of data; it is storage, sized by
+ *  the linker, that is used as the table of a module_init_handle_t
+ *  with the MO_STATIC_TABLE option.
+ */
+typedef module_init_info_t module_init_table_t;
+LINKERSET_DECLARE(module_init_table);
+
+
+#if defined(MODULE_INIT_EDGE_TABLE)
+/* module_init_edge, module_init_csr
+ *
+ *  The 'module_init_edge' linkerset holds one record for each edge of
+ *  every module; see MODULE_INIT_EDGE_TABLE.  'after' is non-zero for
+ *  an ordering-only edge.
+ *
+ *  The 'module_init_csr' section, like 'module_init_table', is
+ *  storage sized by the linker: it has one slot, initially NULL, for
+ *  each record.  module_edge_table_build() fills it.
+ */
+typedef const struct module_init_edge_t {
+    module_init_info_t *importer;
+    module_init_info_t *importee;
+    int                 after;
+} module_init_edge_t;
+LINKERSET_DECLARE(module_init_edge);
+
+typedef module_init_info_t module_init_csr_t;
+LINKERSET_DECLARE(module_init_csr);
+#endif
+
+
+/* MODULE_IMPORT
+ *
+ *  This macro produces an alias name for module_import_t so that each
+ *  module's import list will be kept in a unique linkerset.
+ */
+#define MODULE_IMPORT(mname_) XCONCAT_(mname_,_import_info)
+
+
+/* MODULE_AFTER
+ *
+ *  This macro produces the name of the linkerset that holds the
+ *  ordering-only edges of a module; see IMPORT_AFTER().
+ */
+#define MODULE_AFTER(mname_) XCONCAT_(mname_,_after_info)
+
+
+/* MODULE_INIT
+ *
+ *  This macro produces the name of the module-unique variable that
+ *  holds the initialization information that is put into the
+ *  'module_init_info' linkerset.
+ */
+#define MODULE_INIT(mname_) XCONCAT_(mname_,_init_)
+
+
+/* MODULE_STATE
+ *
+ *  This macro produces the name of the module-unique byte, in the
+ *  'module_init_state' section, that holds the module's init_state_t.
+ */
+#define MODULE_STATE(mname_) XCONCAT_(mname_,_state_)
+
+
+/* MODULE_INIT_DSO
+ *
+ *  Define MODULE_INIT_DSO when compiling a shared object whose modules
+ *  replace those of a program with module_reload(); see
+ *  module_init_reload.h.  The symbols defined by DECLARE_MODULE are
+ *  then hidden, so they do not collide with those of the program's
+ *  modules of the same name, and the shared object exports
+ *  module_dso_modules().
+ */
+#if defined(MODULE_INIT_DSO)
+#define MODULE_VISIBILITY_ __attribute__((visibility("hidden")))
+#else
+#define MODULE_VISIBILITY_
+#endif
+
+
+/* MODULE_EDGES_DECLARE_, MODULE_EDGES_INIT_, MODULE_EDGE_ADD_
+ *
+ *  How DECLARE_MODULE declares the storage of a module's edges, and
+ *  initializes the fields of its module_init_info_t that refer to
+ *  it, and how IMPORT(), IMPORT_WEAK() and IMPORT_AFTER() add an edge
+ *  to 'set_', which is MODULE_IMPORT() or MODULE_AFTER() of the
+ *  importer.  See MODULE_INIT_EDGE_TABLE.
+ */
+#if defined(MODULE_INIT_EDGE_TABLE)
+#define MODULE_EDGES_DECLARE_(mname_)                                   \
+    static module_edges_t XCONCAT_(mname_,_edges_)                      \
+        __attribute__((section("module_init_edges"), used))
+
+#define MODULE_EDGES_INIT_(mname_)                                      \
+    .edges = &XCONCAT_(mname_,_edges_)
+
+#define MODULE_EDGE_ADD_(set_, importer_, importee_, after_)            \
+    static module_init_info_t *XCONCAT_(XCONCAT_(set_,_csr_),importee_) \
+        __attribute__((section("module_init_csr"), used));              \
+    static module_init_edge_t XCONCAT_(XCONCAT_(set_,_),importee_) = {  \
+        .importer = &MODULE_INIT(importer_),                            \
+        .importee = &MODULE_INIT(importee_),                            \
+        .after    = after_                                              \
+    };                                                                  \
+    LINKERSET_ADD_ITEM(module_init_edge,                                \
+                       XCONCAT_(XCONCAT_(set_,_),importee_))
+#else
+#define MODULE_EDGES_DECLARE_(mname_)                                   \
+    typedef module_import_t XCONCAT_(MODULE_IMPORT(mname_),_t);         \
+    typedef module_import_t XCONCAT_(MODULE_AFTER(mname_),_t);          \
+    LINKERSET_DECLARE(MODULE_IMPORT(mname_));                           \
+    LINKERSET_DECLARE(MODULE_AFTER(mname_))
+
+#define MODULE_EDGES_INIT_(mname_)                                      \
+    .imports.start = LINKERSET_START(MODULE_IMPORT(mname_)),            \
+    .imports.stop  = LINKERSET_STOP(MODULE_IMPORT(mname_)),             \
+    .after.start   = LINKERSET_START(MODULE_AFTER(mname_)),             \
+    .after.stop    = LINKERSET_STOP(MODULE_AFTER(mname_))
+
+#define MODULE_EDGE_ADD_(set_, importer_, importee_, after_)            \
+    LINKERSET_ADD_ITEM(set_, MODULE_INIT(importee_))
+#endif
+
+
+/* DECLARE_MODULE
+ *
+ *  This macro declares a module, and sets up all the necessary
+ *  internal state to maintain its initialization information.
+ *
+ *  NOTE:
+ *
+ *    Declaring two modules with the same name is results in undefined
+ *    behavior.
+ *
+ *    Using NULL as the value of init_fn_ results in declaring a
+ *    module with no initialization function.
+ *
+ *    Any further arguments are designated initializers for optional
+ *    fields of the module's module_init_info_t.  For example:
+ *
+ *      DECLARE_MODULE(admin, admin_init, admin_fina, .flags = MF_LAZY);
+ *      DECLARE_MODULE(dict, NULL, dict_fina, .async_init_fn = dict_load);
+ *      DECLARE_MODULE(index, NULL, NULL, .cache_fn = index_cache);
+ *      DECLARE_MODULE(disk, disk_init, NULL, .budget_ms = 2000);
+ *      DECLARE_MODULE(warmer, warmer_init, NULL, .phase = MP_BACKGROUND);
+ *      DECLARE_MODULE(rng, rng_init, NULL, .postfork_fn = rng_reseed);
+ *      DECLARE_MODULE(words, words_init, NULL, .arena_size = 1 << 30);
+ *      DECLARE_MODULE(cache, cache_init, cache_fina, .flags = MF_FINA_MEMORY);
+ */
+#define DECLARE_MODULE(mname_, init_fn_, fina_fn_, ...)                 \
+    MODULE_EDGES_DECLARE_(mname_);                                      \
+    extern int XCONCAT_(mname_,_init_fn)(void);                         \
+    static module_init_info_t *XCONCAT_(mname_,_table_slot_)           \
+        __attribute__((section("module_init_table"), used));            \
+    MODULE_VISIBILITY_ uint8_t MODULE_STATE(mname_)                     \
+        __attribute__((section("module_init_state"))) = IS_UNINITIALIZED; \
+    static unsigned XCONCAT_(mname_,_ordinal_)                          \
+        __attribute__((section("module_init_ordinal"), used));          \
+    static module_init_info_t *XCONCAT_(mname_,_impl_)                  \
+        __attribute__((section("module_init_impl"), used));             \
+    static module_arena_t XCONCAT_(mname_,_arena_)                      \
+        __attribute__((section("module_init_arena"), used));            \
+    MODULE_VISIBILITY_ module_init_info_t MODULE_INIT(mname_) = {       \
+        .module_name = XSTRING_(mname_),                                \
+        .init_fn       = init_fn_,                                      \
+        .init_fn_name  = XSTRING_(init_fn_),                            \
+        .fina_fn       = fina_fn_,                                      \
+        .fina_fn_name  = XSTRING_(fina_fn_),                            \
+        MODULE_EDGES_INIT_(mname_),                                     \
+        .state         = &MODULE_STATE(mname_),                         \
+        .ordinal       = &XCONCAT_(mname_,_ordinal_),                   \
+        .impl          = &XCONCAT_(mname_,_impl_),                      \
+        .arena         = &XCONCAT_(mname_,_arena_),                     \
+        __VA_ARGS__                                                     \
+    };                                                                  \
+    LINKERSET_ADD_ITEM(module_init_info, XCONCAT_(mname_, _init_))
+
+
+/* IMPORT
+ *
+ *   This macro adds an imported module to the set of imports for the
+ *   importer.
+ */
+#define IMPORT(importer_, importee_)                                    \
+    extern module_init_info_t MODULE_INIT(importee_);                   \
+    MODULE_EDGE_ADD_(MODULE_IMPORT(importer_), importer_, importee_, 0);
+
+
+/* IMPORT_WEAK
+ *
+ *   Like IMPORT(), but the importee is only imported if it is linked
+ *   into the program for another reason.  The reference to it is
+ *   weak, so it does not cause the linker to take the importee's
+ *   object from a library.
+ *
+ *   A module should not be imported both weakly and with IMPORT() in
+ *   one source file; the reference would be weak in both.
+ */
+#define IMPORT_WEAK(importer_, importee_)                               \
+    extern module_init_info_t MODULE_INIT(importee_) WEAK_;             \
+    MODULE_EDGE_ADD_(MODULE_IMPORT(importer_), importer_, importee_, 0);
+
+
+/* IMPORT_AFTER
+ *
+ *   Orders 'module_' after 'before_', without importing it: when both
+ *   modules are initialized by the same call, 'before_' is initialized
+ *   first, and finalized last.  Otherwise, the edge has no effect.
+ *   'before_' is not linked, and not initialized, on account of this
+ *   edge, so a lazy 'before_', or one that is not among the imports
+ *   of module_initialization_roots(), stays uninitialized.
+ *
+ *   On-demand initialization, with MODULE_ENSURE_INITIALIZED(), does
+ *   not follow these edges.
+ */
+#define IMPORT_AFTER(module_, before_)                                  \
+    extern module_init_info_t MODULE_INIT(before_) WEAK_;               \
+    MODULE_EDGE_ADD_(MODULE_AFTER(module_), module_, before_, 1);
+
+
+/* init_handle_t
+ *
+ */
+typedef struct module_init_handle_t {
+    /* init_state:
+     *
+     *   The state of initialization at the end of the function
+     *   receiving this type asd an argument.
+     *
+     * table_index:
+     *
+     *   This field is used to index the 'table' field.  When the
+     *   entire table has been successfully processed, its value can
+     *   be one larger than the last valid index into the table.
+     *
+     *   inv: 0 <= table_index <= table_size
+     *
+     * table_size:
+     *
+     *   This is the number of elements allocated for 'table'.
+     *
+     * table:
+     *
+     *   This field is used to topologically sort the set of modules
+     *   into an order suitable for sequential initialization.  If the
+     *   set of modules cannot be put into an order for sequential
+     *   initialization, no modules will be initialized, and
+     *   'init_state' will not be set to IR_SUCCESS.
+     *
+     *   inv:
+     *     (Ai: 0 <= i < table_index: table[i] is valid 'module_init_info_t *') &&
+     *     (Ai: table_index <= i < table_size: table[i] is undefined)
+     *
+     * table_stack:
+     *
+     *   The top of a stack of modules that are being initialized on
+     *   demand; see module_initialize_closure().  The stack grows
+     *   down from the end of 'table', and it is empty when
+     *   'table_stack' == 'table_size'.
+     *
+     *   inv: table_index <= table_stack <= table_size
+     *
+     * options:
+     *
+     *   The module_init_option_t values used to initialize modules.
+     *
+     * timing, timing_count, timing_epoch_ns, timing_child_ns:
+     *
+     *   When MO_TIMING or MO_MEMORY is used, 'timing' has
+     *   'table_size' elements, and 'timing[i]' holds the times of the
+     *   module at 'table[i]'.  Otherwise it is NULL.
+     *
+     *   module_finalization() lowers 'table_index'; 'timing_count'
+     *   keeps the number of modules that were initialized, so their
+     *   times can be reported after finalization.
+     *
+     *   'timing_epoch_ns' is the CLOCK_MONOTONIC time at which
+     *   initialization started, and 'timing_child_ns' accumulates the
+     *   time of on-demand initialization done inside the function
+     *   being timed.
+     *
+     * table_allocated:
+     *
+     *   Non-zero if 'table' was allocated by this module, and must be
+     *   freed.  When a precomputed order is used, 'table' refers to
+     *   read-only memory; it is not allocated, and must not be
+     *   written.
+     *
+     * pending, pending_index, pending_size:
+     *
+     *   The modules of the phases that module_initialization_until()
+     *   did not initialize, in an order suitable for sequential
+     *   initialization.  module_initialization_pending() initializes
+     *   [pending_index, pending_size) of them.  'pending' is NULL if
+     *   there are none.
+     */
+    initialization_result_t    init_state;
+    unsigned                   table_index;
+    unsigned                   table_size;
+    unsigned                   table_stack;
+    module_init_info_t       **table;
+    int                        table_allocated;
+    unsigned                   options;
+    module_timing_t           *timing;
+    unsigned                   timing_count;
+    uint64_t                   timing_epoch_ns;
+    uint64_t                   timing_child_ns;
+    module_init_info_t       **pending;
+    unsigned                   pending_index;
+    unsigned                   pending_size;
+} module_init_handle_t;
+
+
+/* module_init_lazy_handle
+ *
+ *  The handle used to initialize the program's modules.  Modules that
+ *  are initialized on demand are recorded in it, so they will be
+ *  finalized with the rest of the program.
+ *
+ *  This is a weak definition so that all translation units that
+ *  include this header share one variable.
+ */
+module_init_handle_t *module_init_lazy_handle WEAK_;
+
+
+/* module_init_delegate_t
+ *
+ *  An engine whose worker threads run initialization functions on
+ *  behalf of the thread holding module_init_lock.  The workers cannot
+ *  take the lock, so module_ensure_initialized() asks the engine, with
+ *  'ensure', to initialize the modules they need on demand.
+ */
+typedef struct module_init_delegate_t module_init_delegate_t;
+
+struct module_init_delegate_t {
+    initialization_result_t (*ensure)(module_init_delegate_t *delegate,
+                                      module_init_info_t     *mip);
+};
+
+
+/* module_init_lock, module_init_lock_depth
+ *
+ *  A futex-based lock that serializes the functions that sort,
+ *  initialize or finalize modules, so that two threads calling
+ *  module_initialization() do not sort into the same 'ordinal' and
+ *  state bytes at once.  The second caller waits, and then finds the
+ *  modules already initialized.
+ *
+ *  It is a ticket lock: threads take it in the order they asked for
+ *  it, so a thread that releases and retakes it between modules, as
+ *  module_initialization_pending() does, lets the waiting threads in.
+ *
+ *  The lock is recursive: 'module_init_lock_depth' is the number of
+ *  times the calling thread holds it, so initialization functions,
+ *  which run with the lock held, may initialize other modules on
+ *  demand.
+ *
+ *  'module_init_worker' is set on the threads of
+ *  module_initialization_parallel() while they run initialization
+ *  functions on behalf of the thread holding the lock; see
+ *  module_init_delegate_t.
+ *
+ *  These are weak definitions so that all translation units that
+ *  include this header share them.
+ */
+typedef struct module_init_lock_t {
+    uint32_t next;              /* The next ticket to hand out. */
+    uint32_t serving;           /* The ticket of the holder. */
+} module_init_lock_t;
+
+module_init_lock_t                module_init_lock WEAK_;
+__thread unsigned                 module_init_lock_depth WEAK_;
+__thread module_init_delegate_t  *module_init_worker WEAK_;
+
+
+/* module_init_waiters
+ *
+ *  The number of threads waiting, in module_wait_state(), for a
+ *  module to leave IS_INITIALIZING.  module_set_state() only wakes
+ *  them when it is non-zero.
+ */
+unsigned module_init_waiters WEAK_;
+
+
+static inline void
+module_init_lock_acquire(void)
+{
+    uint32_t ticket;
+
+    if (module_init_lock_depth++ != 0) {
+        return;
+    }
+
+    ticket = __atomic_fetch_add(&module_init_lock.next, 1, __ATOMIC_SEQ_CST);
+    for (;;) {
+        const uint32_t serving = __atomic_load_n(&module_init_lock.serving,
+                                                 __ATOMIC_SEQ_CST);
+
+        if (serving == ticket) {
+            break;
+        }
+        syscall(SYS_futex, &module_init_lock.serving, FUTEX_WAIT_PRIVATE,
+                serving, NULL, NULL, 0);
+    }
+}
+
+
+static inline void
+module_init_lock_release(void)
+{
+    uint32_t serving;
+
+    assert(module_init_lock_depth != 0);
+    if (--module_init_lock_depth != 0) {
+        return;
+    }
+
+    /* Every waiter is woken; only the one holding the next ticket
+     * takes the lock, and the others wait again.
+     */
+    serving = __atomic_add_fetch(&module_init_lock.serving, 1,
+                                 __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&module_init_lock.next, __ATOMIC_SEQ_CST) != serving) {
+        syscall(SYS_futex, &module_init_lock.serving, FUTEX_WAKE_PRIVATE,
+                INT_MAX, NULL, NULL, 0);
+    }
+}
+
+
+#if defined(MODULE_INIT_EDGE_TABLE)
+/* module_edge_table_built
+ *
+ *  Non-zero once module_edge_table_build() has filled the
+ *  'module_init_csr' section.  A shared object has its own; see
+ *  MODULE_INIT_DSO.
+ */
+MODULE_VISIBILITY_ int module_edge_table_built WEAK_;
+
+
+/* module_edge_table_build
+ *
+ *   Fills the 'module_init_csr' section from the records of the
+ *   'module_init_edge' linkerset, and points the module_edges_t of
+ *   each module at its part of it.  This is a counting sort of the
+ *   records by importer: the edges of each module keep the order of
+ *   its records, imports first, so modules are sorted exactly as with
+ *   one linkerset of edges per module.
+ *
+ *   It runs once, with module_init_lock held, the first time the
+ *   edges of any module are needed.
+ */
+static inline void
+module_edge_table_build(void)
+{
+    module_init_info_t **csr    = LINKERSET_START(module_init_csr);
+    unsigned             offset = 0;
+
+    assert(LINKERSET_SIZE(module_init_csr, unsigned) ==
+           LINKERSET_SIZE(module_init_edge, unsigned));
+
+    module_init_lock_acquire();
+    if (__atomic_load_n(&module_edge_table_built, __ATOMIC_RELAXED)) {
+        module_init_lock_release();
+        return;
+    }
+
+    LINKERSET_ITERATE(module_init_edge, edge, {
+        module_edges_t *edges = edge->importer->edges;
+
+        ++edges->n_edges;
+        if (!edge->after) {
+            ++edges->n_imports;
+        }
+    });
+
+    /* Until the records are placed, 'n_imports' is where the next
+     * import of the module goes, and 'n_edges' where the next
+     * ordering-only edge goes.  Both end at their final values.
+     */
+    LINKERSET_ITERATE(module_init_info, mip, {
+        module_edges_t *edges = mip->edges;
+
+        edges->start     = &csr[offset];
+        offset          += edges->n_edges;
+        edges->n_edges   = edges->n_imports;
+        edges->n_imports = 0;
+    });
+
+    LINKERSET_ITERATE(module_init_edge, edge, {
+        module_edges_t *edges = edge->importer->edges;
+
+        if (edge->after) {
+            edges->start[edges->n_edges++] = edge->importee;
+        } else {
+            edges->start[edges->n_imports++] = edge->importee;
+        }
+    });
+
+    __atomic_store_n(&module_edge_table_built, 1, __ATOMIC_RELEASE);
+    module_init_lock_release();
+}
+
+
+/* module_edges
+ *
+ *   Returns the edges of 'mip', building the table of edges if that
+ *   has not been done.
+ */
+static inline const module_edges_t *
+module_edges(const module_init_info_t *mip)
+{
+    if (__builtin_expect(!__atomic_load_n(&module_edge_table_built,
+                                          __ATOMIC_ACQUIRE), 0)) {
+        module_edge_table_build();
+    }
+    return mip->edges;
+}
+#endif
+
+
+/* module_state
+ *
+ *   Returns the init_state_t of 'mip', with an acquire load.
+ */
+static inline init_state_t
+module_state(module_init_info_t *mip)
+{
+    return (init_state_t)(__atomic_load_n(mip->state, __ATOMIC_ACQUIRE) &
+                          MODULE_STATE_MASK);
+}
+
+
+/* module_marks
+ *
+ *   Returns the marks of 'mip'.  module_init_lock must be held.
+ */
+static inline unsigned
+module_marks(module_init_info_t *mip)
+{
+    return (__atomic_load_n(mip->state, __ATOMIC_RELAXED) &
+            ~(MODULE_STATE_MASK | MODULE_CANCELED));
+}
+
+
+/* module_mark
+ *
+ *   Replaces the marks of 'mip' with 'marks'.  module_init_lock must
+ *   be held.
+ */
+static inline void
+module_mark(module_init_info_t *mip, unsigned marks)
+{
+    const uint8_t state = __atomic_load_n(mip->state, __ATOMIC_RELAXED);
+
+    __atomic_store_n(mip->state,
+                     (uint8_t)((state & (MODULE_STATE_MASK |
+                                         MODULE_CANCELED)) | marks),
+                     __ATOMIC_RELAXED);
+}
+
+
+/* module_state_word
+ *
+ *   The aligned 32-bit word that holds the state byte of 'mip'; it is
+ *   what threads wait on with futex(2).
+ */
+static inline uint32_t *
+module_state_word(module_init_info_t *mip)
+{
+    return (uint32_t *)((uintptr_t)mip->state & ~(uintptr_t)3);
+}
+
+
+/* module_set_state
+ *
+ *   Publishes 'state' as the state of 'mip', clearing its marks, and
+ *   wakes the threads waiting for it.  module_init_lock must be held,
+ *   or, with module_initialization_parallel(), the engine's lock.
+ */
+static inline void
+module_set_state(module_init_info_t *mip, init_state_t state)
+{
+    /* Sequentially consistent, so that either the store is seen by a
+     * new waiter, or the waiter is counted here.
+     */
+    __atomic_store_n(mip->state, (uint8_t)state, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&module_init_waiters, __ATOMIC_SEQ_CST) != 0) {
+        syscall(SYS_futex, module_state_word(mip), FUTEX_WAKE_PRIVATE,
+                INT_MAX, NULL, NULL, 0);
+    }
+}
+
+
+/* module_wait_state
+ *
+ *   Waits until 'mip' is no longer IS_INITIALIZING.  Other state bytes
+ *   in the same word wake the thread spuriously; it waits again.
+ */
+static inline void
+module_wait_state(module_init_info_t *mip)
+{
+    uint32_t       *word   = module_state_word(mip);
+    const unsigned  offset = (unsigned)((uintptr_t)mip->state & 3);
+
+    __atomic_add_fetch(&module_init_waiters, 1, __ATOMIC_SEQ_CST);
+    for (;;) {
+        const uint32_t w = __atomic_load_n(word, __ATOMIC_SEQ_CST);
+
+        if ((((const uint8_t *)&w)[offset] & MODULE_STATE_MASK) !=
+            IS_INITIALIZING) {
+            break;
+        }
+        syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, w, NULL, NULL, 0);
+    }
+    __atomic_sub_fetch(&module_init_waiters, 1, __ATOMIC_SEQ_CST);
+}
+
+
+/* module_cancel
+ *
+ *   Marks 'mip', which is not initialized, as canceled, and wakes the
+ *   threads waiting for it: its initialization function failed, or
+ *   the call that was going to initialize it stopped because another
+ *   one did.  module_wait_ready() returns ECANCELED for it until it
+ *   is initialized again.  The locks are those of module_set_state().
+ */
+static inline void
+module_cancel(module_init_info_t *mip)
+{
+    __atomic_fetch_or(mip->state, (uint8_t)MODULE_CANCELED,
+                      __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&module_init_waiters, __ATOMIC_SEQ_CST) != 0) {
+        syscall(SYS_futex, module_state_word(mip), FUTEX_WAKE_PRIVATE,
+                INT_MAX, NULL, NULL, 0);
+    }
+}
+
+
+/* module_edge_index
+ *
+ *   Returns the index, among the first 'n' modules of 'ih->table', of
+ *   the module at the end of the 'i'th edge of 'mip', or UINT_MAX if
+ *   that module is not one of them.  An ordering-only edge may lead
+ *   to a module that is not being initialized.
+ */
+static inline unsigned
+module_edge_index(const module_init_handle_t *ih,
+                  unsigned                    n,
+                  const module_init_info_t   *mip,
+                  unsigned                    i)
+{
+    module_init_info_t *edge = module_edge(mip, i);
+
+    if (edge == NULL || *edge->ordinal >= n ||
+        ih->table[*edge->ordinal] != edge) {
+        return UINT_MAX;
+    }
+    return *edge->ordinal;
+}
+
+
+/* module_handle_unmark
+ *
+ *   Clears the marks of the modules in [first, last) of 'ih->table'.
+ *   module_init_lock must be held.
+ */
+static inline void
+module_handle_unmark(module_init_handle_t *ih, unsigned first, unsigned last)
+{
+    unsigned i;
+
+    for (i = first; i < last; ++i) {
+        if (module_marks(ih->table[i]) != 0) {
+            module_mark(ih->table[i], 0);
+        }
+    }
+}
+
+
+/* module_handle_cancel
+ *
+ *   Cancels the modules in [first, last) of 'ih->table', and those
+ *   'ih' left pending, that are not initialized; 'ih' will not
+ *   initialize them, because an initialization function failed.  See
+ *   module_cancel().
+ */
+static inline void
+module_handle_cancel(module_init_handle_t *ih, unsigned first, unsigned last)
+{
+    unsigned i;
+
+    for (i = first; i < last; ++i) {
+        if (module_state(ih->table[i]) != IS_INITIALIZED) {
+            module_cancel(ih->table[i]);
+        }
+    }
+    for (i = ih->pending_index; i < ih->pending_size; ++i) {
+        if (module_state(ih->pending[i]) != IS_INITIALIZED) {
+            module_cancel(ih->pending[i]);
+        }
+    }
+}
+
+
+static inline void
+module_handle_initialize(module_init_handle_t *ih, unsigned table_size)
+{
+    ih->init_state  = IR_SUCCESS;
+    ih->table_size  = table_size;
+    ih->table_stack = table_size;
+    ih->table       = 0;
+    ih->table_index = 0;
+    if (table_size != 0) {
+        ih->table = calloc(ih->table_size, sizeof(module_init_info_t *));
+    }
+    ih->table_allocated = ih->table != NULL;
+    ih->options         = 0;
+    ih->timing          = NULL;
+    ih->timing_count    = 0;
+    ih->timing_epoch_ns = 0;
+    ih->timing_child_ns = 0;
+    ih->pending         = NULL;
+    ih->pending_index   = 0;
+    ih->pending_size    = 0;
+}
+
+
+/* module_handle_static_table
+ *
+ *   Returns the 'module_init_table' section, or NULL if it does not
+ *   have one slot for each module in the program.  The slots are
+ *   only missing when the linker has discarded them, for example with
+ *   --gc-sections and no reference to 'module_init_table'.
+ */
+static inline module_init_info_t **
+module_handle_static_table(void)
+{
+    if (LINKERSET_SIZE(module_init_table, unsigned) !=
+        LINKERSET_SIZE(module_init_info, unsigned)) {
+        return NULL;
+    }
+    return LINKERSET_START(module_init_table);
+}
+
+
+/* module_handle_initialize_static
+ *
+ *   Like module_handle_initialize(), but 'ih->table' is the
+ *   'module_init_table' section, and nothing is allocated.  If the
+ *   section is not usable, 'ih->table' is NULL.
+ */
+static inline void
+module_handle_initialize_static(module_init_handle_t *ih)
+{
+    module_handle_initialize(ih, 0);
+    ih->table = module_handle_static_table();
+    if (ih->table != NULL) {
+        ih->table_size  = LINKERSET_SIZE(module_init_info, unsigned);
+        ih->table_stack = ih->table_size;
+    }
+}
+
+
+/* module_handle_finalize
+ *
+ *  Frees dynamically allocated resources, and resets the state of the
+ *  handler so that subsequent usage will not cause a invalid memory
+ *  reference.
+ *
+ *  This must be called by a client of this library when use of the
+ *  module initialization / finalization system is done.
+ */
+static inline void
+module_handle_finalize(module_init_handle_t *ih)
+{
+    /* Modules that were sorted, but not initialized, are unmarked. */
+    module_init_lock_acquire();
+    if (ih->table != NULL) {
+        module_handle_unmark(ih, 0, ih->table_index);
+    }
+    if (ih->table_allocated) {
+        free(ih->table);
+    }
+    free(ih->timing);
+    free(ih->pending);
+    if (module_init_lazy_handle == ih) {
+        module_init_lazy_handle = NULL;
+    }
+    module_handle_initialize(ih, 0);
+    module_init_lock_release();
+}
+
+
+static inline uint64_t
+module_clock_ns(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+
+/* module_call_t
+ *
+ *  Internal type.  The state of a timed call between
+ *  module_call_begin() and module_call_end().
+ */
+typedef struct module_call_t {
+    uint64_t         wall;
+    uint64_t         cpu;
+    uint64_t         saved_child_ns;
+    module_memory_t *saved_memory;
+} module_call_t;
+
+
+/* module_call_begin
+ *
+ *   Starts timing a call.  The allocations made on this thread until
+ *   module_call_end() are charged to 'memory', unless it is NULL.
+ */
+static inline void
+module_call_begin(module_call_t   *call,
+                  uint64_t        *child_ns,
+                  module_memory_t *memory)
+{
+    call->saved_child_ns = *child_ns;
+    call->saved_memory   = module_init_memory;
+    *child_ns            = 0;
+    module_init_memory   = memory;
+    call->wall           = module_clock_ns(CLOCK_MONOTONIC);
+    call->cpu            = module_clock_ns(CLOCK_THREAD_CPUTIME_ID);
+}
+
+
+static inline void
+module_call_end(module_init_handle_t *ih,
+                const module_call_t  *call,
+                module_time_t        *time,
+                uint64_t             *child_ns)
+{
+    time->cpu_ns       = module_clock_ns(CLOCK_THREAD_CPUTIME_ID) - call->cpu;
+    time->wall_ns      = module_clock_ns(CLOCK_MONOTONIC) - call->wall;
+    time->start_ns     = call->wall - ih->timing_epoch_ns;
+    time->self_ns      = (time->wall_ns > *child_ns
+                          ? time->wall_ns - *child_ns
+                          : 0);
+    *child_ns          = call->saved_child_ns + time->wall_ns;
+    module_init_memory = call->saved_memory;
+}
+
+
+/* module_call
+ *
+ *   Calls 'fn', an initialization or finalization function, and
+ *   returns its result.  Unless 'time' is NULL, the time taken by
+ *   the call is recorded in it.
+ *
+ *   '*child_ns' accumulates the wall time of all timed calls made at
+ *   the same level on one thread; it is how the time of on-demand
+ *   initialization is removed from the 'self_ns' of the caller.
+ */
+static inline int
+module_call(module_init_handle_t *ih,
+            int                 (*fn)(void),
+            module_time_t        *time,
+            uint64_t             *child_ns)
+{
+    module_call_t call;
+    int           result;
+
+    if (time == NULL) {
+        return fn();
+    }
+
+    module_call_begin(&call, child_ns, NULL);
+    result = fn();
+    module_call_end(ih, &call, time, child_ns);
+    return result;
+}
+
+
+static inline void
+module_async_signal(module_completion_t *completion, int result)
+{
+    completion->result = result;
+    __atomic_store_n(&completion->done, 1, __ATOMIC_RELEASE);
+    syscall(SYS_futex, &completion->done, FUTEX_WAKE_PRIVATE, INT_MAX,
+            NULL, NULL, 0);
+}
+
+
+/* module_async_wait
+ *
+ *   Calls the asynchronous initialization function of 'mip', and, if
+ *   it is pending, waits for it to complete.  Returns its result.
+ */
+static inline int
+module_async_wait(module_init_info_t *mip)
+{
+    module_completion_t completion = {
+        .module   = mip,
+        .complete = module_async_signal,
+    };
+    int                 result;
+
+    result = module_impl(mip)->async_init_fn(&completion);
+
+    if (result != MODULE_INIT_PENDING) {
+        return result;
+    }
+
+    while (__atomic_load_n(&completion.done, __ATOMIC_ACQUIRE) == 0) {
+        syscall(SYS_futex, &completion.done, FUTEX_WAIT_PRIVATE, 0,
+                NULL, NULL, 0);
+    }
+    return completion.result;
+}
+
+
+/* module_cache_call
+ *
+ *   Initializes the cacheable module 'mip' from module_init_cache, or
+ *   by building its blob, which is then stored in the cache.  Returns
+ *   the result of its 'cache_fn'.
+ */
+static inline int
+module_cache_call(module_init_info_t *mip)
+{
+    module_init_info_t *impl        = module_impl(mip);
+    module_cache_t     *cache       = module_init_cache;
+    uint64_t            fingerprint = 0;
+    module_blob_t       blob        = { NULL, 0 };
+    int                 result;
+
+    if (cache != NULL) {
+        if (impl->fingerprint_fn != NULL) {
+            fingerprint = impl->fingerprint_fn();
+        }
+        if (cache->load(cache, mip, fingerprint, &blob) == 0 &&
+            impl->cache_fn(&blob, NULL) == 0) {
+            return 0;
+        }
+    }
+
+    blob.data = NULL;
+    blob.size = 0;
+    result    = impl->cache_fn(NULL, &blob);
+    if (result == 0 && cache != NULL && blob.data != NULL) {
+        cache->store(cache, mip, fingerprint, &blob);
+    }
+    return result;
+}
+
+
+/* module_init_call
+ *
+ *   Initializes 'mip' with whichever initialization function it has,
+ *   as module_call() does, and returns the result.  Zero is returned
+ *   if it has none.  An asynchronous initialization function is
+ *   waited for.
+ *
+ *   Unless 'timing' is NULL, the time of the call is recorded in
+ *   'timing->init', and, with MO_MEMORY, its allocations in
+ *   'timing->memory'.  The call is reported to module_init_watch.
+ */
+static inline int
+module_init_call(module_init_handle_t *ih,
+                 module_init_info_t   *mip,
+                 module_timing_t      *timing,
+                 uint64_t             *child_ns)
+{
+    module_watch_t *watch = module_init_watch;
+    module_call_t   call  = { 0 };
+    int             result;
+
+    if (!module_has_init(mip)) {
+        return 0;
+    }
+
+    if (watch != NULL) {
+        watch->begin(watch, mip);
+    }
+    if (timing != NULL) {
+        module_call_begin(&call, child_ns,
+                          (ih->options & MO_MEMORY
+                           ? &timing->memory
+                           : NULL));
+    }
+    if (module_impl(mip)->cache_fn != NULL) {
+        result = module_cache_call(mip);
+    } else if (module_impl(mip)->async_init_fn != NULL) {
+        result = module_async_wait(mip);
+    } else {
+        result = module_impl(mip)->init_fn();
+    }
+    if (timing != NULL) {
+        module_call_end(ih, &call, &timing->init, child_ns);
+    }
+    if (watch != NULL) {
+        watch->end(watch, mip);
+    }
+    return result;
+}
+
+
+/* topological_sort_module
+ *
+ *   This function appends 'root', and every module it transitively
+ *   imports that has not already been sorted, to 'ih->table' in an
+ *   order suitable for sequential initialization: each module is
+ *   placed after all of its imports.  Imports are visited depth
+ *   first, in the order of the module's import linkerset, and then
+ *   its ordering-only edges are followed in the same way.  Weak edges
+ *   to modules that are not linked are ignored.
+ *
+ *   The traversal is not recursive.  The modules being visited are
+ *   kept on an explicit stack that grows down from the end of
+ *   'ih->table'.  A module is either sorted (in [0, table_index)), on
+ *   the stack, or not yet visited, so the stack and the sorted
+ *   modules never overlap, and no memory beyond 'ih->table' is
+ *   needed.
+ *
+ *   While a module is on the stack (MODULE_MARK_VISITING), its
+ *   'ordinal' field holds the index of the next edge to visit; it is
+ *   set to the module's position in 'ih->table' when the module is
+ *   sorted (MODULE_MARK_SORTED).  The marks stay set until the module
+ *   is initialized, or module_handle_unmark() is called; the published
+ *   state of the modules is not changed, so the sort does not disturb
+ *   threads that test it.  module_init_lock must be held.
+ *
+ *   If a cycle is found, 'ih->init_state' is set to IR_CYCLE, and
+ *   [0, table_index) of 'ih->table' holds the module that closed the
+ *   cycle, followed by the modules on the stack, innermost first.
+ *   The stack ends with the module that closed the cycle, and then
+ *   its (transitive) importers that are not part of the cycle.  No
+ *   module is left marked.
+ */
+static inline void
+topological_sort_module(module_init_handle_t *ih,
+                        module_init_info_t   *root)
+{
+    unsigned sp    = ih->table_size; /* Stack top; grows down. */
+    uint8_t  state = __atomic_load_n(root->state, __ATOMIC_RELAXED);
+
+    if ((state & ~MODULE_CANCELED) != IS_UNINITIALIZED) {
+        assert(module_state(root) == IS_INITIALIZED ||
+               (module_marks(root) & MODULE_MARK_SORTED) != 0);
+        return;
+    }
+
+    /* The modules on the stack, and the sorted ones, are
+     * IS_UNINITIALIZED, so their marks are stored directly.
+     */
+    assert(ih->table_index < sp);
+    __atomic_store_n(root->state, (uint8_t)(state | MODULE_MARK_VISITING),
+                     __ATOMIC_RELAXED);
+    *root->ordinal = 0;
+    --sp;
+    ih->table[sp]  = root;
+
+    while (sp < ih->table_size) {
+        module_init_info_t *mip  = ih->table[sp];
+        const unsigned      next = *mip->ordinal;
+
+        /* The ordering-only edges are only counted once the imports
+         * have been visited; most modules have none.
+         */
+        if (next < module_n_imports(mip) || next < module_n_edges(mip)) {
+            /* Follow the next edge, depth first. */
+            module_init_info_t *impp = module_edge(mip, next);
+
+            *mip->ordinal = next + 1;
+            if (impp == NULL) {
+                continue;       /* A weak edge to an absent module. */
+            }
+
+            state = __atomic_load_n(impp->state, __ATOMIC_RELAXED);
+            if ((state & ~MODULE_CANCELED) == IS_UNINITIALIZED) {
+                assert(ih->table_index < sp);
+                __atomic_store_n(impp->state,
+                                 (uint8_t)(state | MODULE_MARK_VISITING),
+                                 __ATOMIC_RELAXED);
+                *impp->ordinal = 0;
+                --sp;
+                ih->table[sp]  = impp;
+            } else if ((state & MODULE_MARK_VISITING) != 0 ||
+                       (state & MODULE_STATE_MASK) == IS_INITIALIZING) {
+                /* Cycle detected.  Store offending module, and the
+                 * stack of importers, in the cycle table.  If every
+                 * module is on the stack, the outermost is dropped
+                 * to fit.
+                 */
+                unsigned depth = ih->table_size - sp;
+
+                if (depth == ih->table_size) {
+                    --depth;
+                }
+
+                module_handle_unmark(ih, 0, ih->table_index);
+                module_handle_unmark(ih, sp, ih->table_size);
+                memmove(&ih->table[1], &ih->table[sp],
+                        depth * sizeof(module_init_info_t *));
+                ih->init_state  = IR_CYCLE;
+                ih->table[0]    = impp;
+                ih->table_index = depth + 1;
+                return;
+            } else {
+                assert(state == IS_INITIALIZED ||
+                       (state & MODULE_MARK_SORTED) != 0);
+            }
+        } else {
+            /* mip is a module that is clear to be initialized. */
+            ++sp;
+            *mip->ordinal              = ih->table_index;
+            module_mark(mip, MODULE_MARK_SORTED);
+            ih->table[ih->table_index] = mip;
+            ++ih->table_index;
+        }
+    }
+}
+
+
+/* topological_sort_modules
+ *
+ *   Sorts all modules that are not yet initialized into 'ih->table',
+ *   phase by phase: the modules of each phase, and their imports, are
+ *   sorted before those of the next.  When no module imports a module
+ *   of a later phase, the table is then ordered by phase.  Most
+ *   programs only use the default phase, and need a single pass.
+ */
+static inline void
+topological_sort_modules(module_init_handle_t *ih)
+{
+    unsigned phase = MP_EARLY;
+    unsigned last  = MP_EARLY;
+
+    do {
+        LINKERSET_ITERATE(module_init_info, mi, {
+                if (mi->phase == phase) {
+                    topological_sort_module(ih, mi);
+                    if (ih->init_state != IR_SUCCESS) {
+                        return;
+                    }
+                } else if (mi->phase > last) {
+                    last = mi->phase;
+                }
+            });
+        ++phase;
+    } while (phase <= last);
+    assert(ih->table_index <= ih->table_size);
+}
+
+
+/* module_init_order_t
+ *
+ *   A precomputed initialization order for all the modules in the
+ *   program.  It is produced after the program's modules have been
+ *   linked once, by module_init_order_write() (module_init_order.h),
+ *   as a C source file that is compiled and linked into the program.
+ *   See examples/initialization/Makefile.
+ *
+ *   n_modules:
+ *
+ *     The number of modules in the program when the order was
+ *     computed.
+ *
+ *   table:
+ *
+ *     The modules, in an order suitable for sequential
+ *     initialization.
+ *
+ *   n_imports:
+ *
+ *     The number of edges, imports and ordering-only edges, each
+ *     module in 'table' had when the order was computed.
+ *
+ *   When the table is present, and still matches the modules linked
+ *   into the program, module initialization uses it directly; no
+ *   memory is allocated and no sort is done.  If the set of modules,
+ *   or the number of edges of any module, has changed since the
+ *   order was computed, or if a module now comes before one of the
+ *   modules it has an edge to, the order is stale and it is ignored.
+ */
+typedef struct module_init_order_t {
+    unsigned                   n_modules;
+    module_init_info_t *const *table;
+    const unsigned            *n_imports;
+} module_init_order_t;
+
+extern const module_init_order_t module_init_order WEAK_;
+
+
+/* MODULE_INIT_ORDER_SECTION
+ *
+ *  The section that holds the precomputed initialization order.  It
+ *  is read-only once the program has been relocated.
+ */
+#define MODULE_INIT_ORDER_SECTION                               \
+    __attribute__((section(".data.rel.ro.module_init_order")))
+
+
+/* module_handle_precomputed
+ *
+ *   If a precomputed initialization order is linked into the program,
+ *   and it is not stale, 'ih' is set to refer to it and non-zero is
+ *   returned.  Otherwise 'ih' is unchanged, and zero is returned.
+ *
+ *   The order is checked in one pass over the edges, once the
+ *   ordinals have been set from it: every module an edge leads to
+ *   must come earlier.
+ */
+static inline int
+module_handle_precomputed(module_init_handle_t *ih)
+{
+    const unsigned n = LINKERSET_SIZE(module_init_info, unsigned);
+    unsigned       i;
+
+    if (&module_init_order == NULL ||
+        module_init_order.n_modules != n || n == 0) {
+        return 0;
+    }
+
+    for (i = 0; i < n; ++i) {
+        if (module_n_edges(module_init_order.table[i]) !=
+            module_init_order.n_imports[i]) {
+            return 0;
+        }
+    }
+
+    for (i = 0; i < n; ++i) {
+        *module_init_order.table[i]->ordinal = i;
+    }
+
+    for (i = 0; i < n; ++i) {
+        module_init_info_t *mip = module_init_order.table[i];
+        unsigned            e;
+
+        for (e = 0; e < module_n_edges(mip); ++e) {
+            module_init_info_t *impp = module_edge(mip, e);
+
+            if (impp != NULL && *impp->ordinal >= i) {
+                return 0;
+            }
+        }
+    }
+
+    module_handle_initialize(ih, 0);
+    ih->table_size      = n;
+    ih->table_stack     = n;
+    ih->table_index     = n;
+    ih->table           = (module_init_info_t **)module_init_order.table;
+    ih->table_allocated = 0;
+    return 1;
+}
+
+
+/* module_initialize_closure
+ *
+ *   This function initializes 'root', and every module it
+ *   transitively imports that is not yet initialized.  Imports are
+ *   visited depth first, as in topological_sort_module(), and each
+ *   module is initialized as soon as all of its imports are.
+ *   Ordering-only edges are not followed.  When a
+ *   module's initialization function succeeds, the module is appended
+ *   to [0, table_index) of 'ih->table', so 'ih->table' records the
+ *   order in which modules were actually initialized.
+ *
+ *   The modules being visited are kept on the stack that starts at
+ *   'ih->table_stack'.  An enclosing call, whose initialization
+ *   function is running, leaves its own modules on the stack, so
+ *   initialization functions may themselves initialize other modules
+ *   on demand.
+ *
+ *   The result is:
+ *
+ *     IR_SUCCESS: 'root' is initialized.
+ *
+ *     IR_FAILED:  An initialization function failed.
+ *                 'ih->init_state' is set to IR_FAILED, and the
+ *                 module is stored at ih->table[ih->table_index].
+ *                 No further modules will be initialized with 'ih'.
+ *
+ *     IR_CYCLE:   'root' depends on a module that is still being
+ *                 initialized.  This happens when an initialization
+ *                 function asks for a module that (transitively)
+ *                 imports its own module, or for a module that an
+ *                 enclosing call of module_initialization() has
+ *                 sorted but not yet initialized.  'ih' is unchanged.
+ *
+ *   Modules that were on the stack when initialization stopped, and
+ *   a module that failed, are returned to IS_UNINITIALIZED.  If one
+ *   failed, they are canceled, as are the modules 'ih' left pending.
+ *   module_init_lock must be held.
+ */
+static inline initialization_result_t
+module_initialize_closure(module_init_handle_t *ih,
+                          module_init_info_t   *root)
+{
+    const unsigned          base   = ih->table_stack;
+    initialization_result_t result = IR_SUCCESS;
+
+    if (module_state(root) == IS_INITIALIZED) {
+        return IR_SUCCESS;
+    } else if (module_state(root) == IS_INITIALIZING ||
+               module_marks(root) != 0) {
+        return IR_CYCLE;
+    } else if (ih->init_state != IR_SUCCESS) {
+        return ih->init_state;
+    }
+
+    assert(ih->table_index < ih->table_stack);
+    module_set_state(root, IS_INITIALIZING);
+    *root->ordinal = 0;
+    --ih->table_stack;
+    ih->table[ih->table_stack] = root;
+
+    while (ih->table_stack < base) {
+        module_init_info_t *mip = ih->table[ih->table_stack];
+
+        if (*mip->ordinal < module_n_imports(mip)) {
+            module_init_info_t *impp = module_edge(mip, *mip->ordinal);
+
+            ++*mip->ordinal;
+            if (impp == NULL) {
+                continue;
+            } else if (module_state(impp) == IS_UNINITIALIZED &&
+                       module_marks(impp) == 0) {
+                assert(ih->table_index < ih->table_stack);
+                module_set_state(impp, IS_INITIALIZING);
+                *impp->ordinal = 0;
+                --ih->table_stack;
+                ih->table[ih->table_stack] = impp;
+            } else if (module_state(impp) != IS_INITIALIZED) {
+                result = IR_CYCLE;
+                break;
+            }
+        } else {
+            int             init_result = 0;
+            module_timing_t timing      = { 0 };
+
+            /* 'mip' stays on the stack while its initialization
+             * function runs, so on-demand initialization started by
+             * the function pushes above it.
+             */
+            init_result = module_init_call(ih, mip,
+                                           ih->timing != NULL ? &timing : NULL,
+                                           &ih->timing_child_ns);
+            ++ih->table_stack;
+
+            if (ih->timing != NULL) {
+                ih->timing[ih->table_index] = timing;
+            }
+
+            if (init_result != 0) {
+                module_arena_release(module_impl(mip));
+                module_set_state(mip, IS_UNINITIALIZED);
+                module_cancel(mip);
+                ih->init_state             = IR_FAILED;
+                ih->table[ih->table_index] = mip;
+                result                     = IR_FAILED;
+                break;
+            }
+
+            *mip->ordinal              = ih->table_index;
+            module_set_state(mip, IS_INITIALIZED);
+            ih->table[ih->table_index] = mip;
+            ++ih->table_index;
+        }
+    }
+
+    while (ih->table_stack < base) {
+        module_set_state(ih->table[ih->table_stack], IS_UNINITIALIZED);
+        if (result == IR_FAILED) {
+            module_cancel(ih->table[ih->table_stack]);
+        }
+        ++ih->table_stack;
+    }
+    if (result == IR_FAILED) {
+        module_handle_cancel(ih, 0, 0); /* Those left pending. */
+    }
+    return result;
+}
+
+
+/* module_ensure_initialized
+ *
+ *   Initializes 'mip', and its imports, if it is not yet initialized.
+ *   Generally, MODULE_ENSURE_INITIALIZED() should be used instead.
+ *
+ *   It may be called from any thread.  If another thread is running
+ *   the initialization function of 'mip', the caller waits for it to
+ *   return.  Otherwise, the caller takes module_init_lock, which
+ *   waits for any initialization in progress on other threads, and
+ *   initializes 'mip' only if that did not.
+ *
+ *   The result is that of module_initialize_closure().  If the
+ *   program's modules have not been initialized with
+ *   module_initialization(), IR_FAILED is returned.  On the worker
+ *   threads of module_initialization_parallel(), which run with the
+ *   lock held by another thread, the engine initializes 'mip' on the
+ *   calling thread instead; see module_init_delegate_t.
+ */
+static inline initialization_result_t
+module_ensure_initialized(module_init_info_t *mip)
+{
+    initialization_result_t result;
+
+    if (module_state(mip) == IS_INITIALIZED) {
+        return IR_SUCCESS;
+    } else if (module_init_worker != NULL) {
+        return module_init_worker->ensure(module_init_worker, mip);
+    }
+
+    /* While this thread holds the lock, a module that is
+     * IS_INITIALIZING is its own, and the closure reports the cycle.
+     */
+    while (module_init_lock_depth == 0 &&
+           module_state(mip) == IS_INITIALIZING) {
+        module_wait_state(mip);
+    }
+
+    module_init_lock_acquire();
+    if (module_state(mip) == IS_INITIALIZED) {
+        result = IR_SUCCESS;
+    } else if (module_init_lazy_handle == NULL) {
+        result = IR_FAILED;
+    } else {
+        result = module_initialize_closure(module_init_lazy_handle, mip);
+    }
+    module_init_lock_release();
+    return result;
+}
+
+
+/* MODULE_ENSURE_INITIALIZED
+ *
+ *   Ensures the module 'mname_', which is usually declared with
+ *   MF_LAZY, is initialized before it is used, and produces the
+ *   initialization_result_t of doing so.
+ *
+ *   Once the module has been initialized, this is a single, predicted
+ *   acquire load and comparison of the module's state byte; on x86-64
+ *   and AArch64 the load is an ordinary one.
+ */
+#define MODULE_ENSURE_INITIALIZED(mname_)                               \
+    ({                                                                  \
+        extern module_init_info_t MODULE_INIT(mname_);                  \
+        extern uint8_t            MODULE_STATE(mname_);                 \
+        __builtin_expect(__atomic_load_n(&MODULE_STATE(mname_),         \
+                                         __ATOMIC_ACQUIRE) ==           \
+                         IS_INITIALIZED, 1)                             \
+            ? IR_SUCCESS                                                \
+            : module_ensure_initialized(&MODULE_INIT(mname_));          \
+    })
+
+
+/* module_try_ready
+ *
+ *   Returns non-zero if 'mip' is initialized.  This is one acquire
+ *   load; the module is neither initialized nor waited for.
+ */
+static inline int
+module_try_ready(module_init_info_t *mip)
+{
+    return __atomic_load_n(mip->state, __ATOMIC_ACQUIRE) == IS_INITIALIZED;
+}
+
+
+/* module_wait_ready_until
+ *
+ *   Waits until 'mip' has been initialized, by whichever thread
+ *   initializes it, or until the CLOCK_MONOTONIC time '*deadline', if
+ *   'deadline' is not NULL.  Unlike MODULE_ENSURE_INITIALIZED(), it
+ *   does not initialize the module; it is for code that runs ahead of
+ *   module_initialization_background(), or of another thread that is
+ *   initializing modules.
+ *
+ *   The result is zero once the module is initialized, ETIMEDOUT if
+ *   the deadline passed first, or ECANCELED if the module is canceled:
+ *   its initialization function failed, or the call that was to
+ *   initialize it stopped because another one failed.  See
+ *   module_cancel().
+ *
+ *   The thread sleeps in futex(2) on the word holding the module's
+ *   state byte, and is woken when the state is published.  An
+ *   initialization function must only wait for modules it imports;
+ *   any other may be initialized after it, on the same thread.
+ */
+static inline int
+module_wait_ready_until(module_init_info_t    *mip,
+                        const struct timespec *deadline)
+{
+    uint32_t       *word   = module_state_word(mip);
+    const unsigned  offset = (unsigned)((uintptr_t)mip->state & 3);
+    int             result = 0;
+
+    if (module_try_ready(mip)) {
+        return 0;
+    }
+
+    __atomic_add_fetch(&module_init_waiters, 1, __ATOMIC_SEQ_CST);
+    for (;;) {
+        const uint32_t w     = __atomic_load_n(word, __ATOMIC_SEQ_CST);
+        const uint8_t  state = ((const uint8_t *)&w)[offset];
+
+        if (state == IS_INITIALIZED) {
+            break;
+        }
+        if ((state & MODULE_CANCELED) != 0) {
+            result = ECANCELED;
+            break;
+        }
+        if (syscall(SYS_futex, word, FUTEX_WAIT_BITSET_PRIVATE, w, deadline,
+                    NULL, FUTEX_BITSET_MATCH_ANY) != 0 &&
+            errno == ETIMEDOUT) {
+            result = module_try_ready(mip) ? 0 : ETIMEDOUT;
+            break;
+        }
+    }
+    __atomic_sub_fetch(&module_init_waiters, 1, __ATOMIC_SEQ_CST);
+    return result;
+}
+
+
+/* module_wait_ready
+ *
+ *   Waits, without a time limit, until 'mip' has been initialized.
+ *   See module_wait_ready_until().
+ */
+static inline int
+module_wait_ready(module_init_info_t *mip)
+{
+    return module_wait_ready_until(mip, NULL);
+}
+
+
+/* module_wait_ready_for
+ *
+ *   Waits at most 'timeout_ns' nanoseconds until 'mip' has been
+ *   initialized.  See module_wait_ready_until().
+ */
+static inline int
+module_wait_ready_for(module_init_info_t *mip, uint64_t timeout_ns)
+{
+    struct timespec deadline;
+    uint64_t        ns;
+
+    if (module_try_ready(mip)) {
+        return 0;
+    }
+
+    ns               = module_clock_ns(CLOCK_MONOTONIC) + timeout_ns;
+    deadline.tv_sec  = (time_t)(ns / 1000000000u);
+    deadline.tv_nsec = (long)(ns % 1000000000u);
+    return module_wait_ready_until(mip, &deadline);
+}
+
+
+/* MODULE_TRY_READY, MODULE_WAIT_READY, MODULE_WAIT_READY_FOR
+ *
+ *   module_try_ready(), module_wait_ready() and
+ *   module_wait_ready_for() for the module 'mname_'.  Once the module
+ *   is initialized, each is a single acquire load and comparison of
+ *   the module's state byte.
+ */
+#define MODULE_TRY_READY(mname_)                                        \
+    ({                                                                  \
+        extern uint8_t MODULE_STATE(mname_);                            \
+        __atomic_load_n(&MODULE_STATE(mname_), __ATOMIC_ACQUIRE) ==     \
+            IS_INITIALIZED;                                             \
+    })
+
+#define MODULE_WAIT_READY(mname_)                                       \
+    ({                                                                  \
+        extern module_init_info_t MODULE_INIT(mname_);                  \
+        MODULE_TRY_READY(mname_)                                        \
+            ? 0                                                         \
+            : module_wait_ready(&MODULE_INIT(mname_));                  \
+    })
+
+#define MODULE_WAIT_READY_FOR(mname_, timeout_ns_)                      \
+    ({                                                                  \
+        extern module_init_info_t MODULE_INIT(mname_);                  \
+        MODULE_TRY_READY(mname_)                                        \
+            ? 0                                                         \
+            : module_wait_ready_for(&MODULE_INIT(mname_), timeout_ns_); \
+    })
+
+
+/* module_handle_writable
+ *
+ *   Ensures 'ih->table' can be written, copying a precomputed order
+ *   into the 'module_init_table' section, if MO_STATIC_TABLE is used,
+ *   or allocated memory if necessary.  Returns 0, and sets
+ *   'ih->init_state' to IR_MEMORY, if memory could not be allocated.
+ */
+static inline int
+module_handle_writable(module_init_handle_t *ih)
+{
+    module_init_info_t **table = module_handle_static_table();
+
+    if (ih->table_allocated || (table != NULL && ih->table == table)) {
+        return 1;
+    }
+
+    if (table == NULL || (ih->options & MO_STATIC_TABLE) == 0) {
+        table = calloc(ih->table_size, sizeof(module_init_info_t *));
+        if (table == NULL) {
+            ih->init_state = IR_MEMORY;
+            return 0;
+        }
+        ih->table_allocated = 1;
+    }
+    memcpy(table, ih->table, ih->table_size * sizeof(module_init_info_t *));
+    ih->table = table;
+    return 1;
+}
+
+
+/* module_handle_is_partial
+ *
+ *   Returns non-zero if any module in [0, table_index) of the sorted
+ *   'ih->table' is lazy, or is already initialized.  Only a
+ *   precomputed order holds initialized modules; the sort skips them.
+ */
+static inline int
+module_handle_is_partial(module_init_handle_t *ih)
+{
+    unsigned i;
+
+    for (i = 0; i < ih->table_index; ++i) {
+        if ((ih->table[i]->flags & MF_LAZY) ||
+            module_state(ih->table[i]) == IS_INITIALIZED) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/* module_handle_closure
+ *
+ *   Removes the modules that are not (transitively) imported by one
+ *   of the 'n_roots' modules in 'roots' from [0, table_index) of the
+ *   sorted 'ih->table'.  If 'roots' is NULL, every module that is not
+ *   lazy is a root.  Modules only reached by ordering-only edges, and
+ *   modules that are already initialized, are removed.
+ *
+ *   On return, [0, table_index) holds the remaining modules, still in
+ *   sorted order and with their ordinals updated, and no module is
+ *   marked.  If memory for a writable table could not be allocated,
+ *   'ih->init_state' is IR_MEMORY.  module_init_lock must be held.
+ */
+static inline void
+module_handle_closure(module_init_handle_t      *ih,
+                      module_init_info_t *const *roots,
+                      unsigned                   n_roots)
+{
+    unsigned i;
+    unsigned n = 0;
+
+    module_handle_unmark(ih, 0, ih->table_index);
+    if (!module_handle_writable(ih)) {
+        return;
+    }
+
+    /* MODULE_MARK_NEEDED marks modules that must be initialized.
+     * Importers are after their imports in the table, so one
+     * backwards pass finds the transitive imports of all roots.
+     * Initialized modules are never marked; their imports are
+     * initialized too.
+     */
+    for (i = 0; i < n_roots; ++i) {
+        if (module_state(roots[i]) != IS_INITIALIZED) {
+            module_mark(roots[i], MODULE_MARK_NEEDED);
+        }
+    }
+
+    i = ih->table_index;
+    while (i != 0) {
+        module_init_info_t *mip = ih->table[--i];
+
+        if (module_state(mip) == IS_INITIALIZED) {
+            continue;
+        }
+        if ((roots == NULL && (mip->flags & MF_LAZY) == 0) ||
+            module_marks(mip) != 0) {
+            unsigned e;
+
+            module_mark(mip, MODULE_MARK_NEEDED);
+            for (e = 0; e < module_n_imports(mip); ++e) {
+                module_init_info_t *impp = module_edge(mip, e);
+
+                if (impp != NULL && module_state(impp) != IS_INITIALIZED) {
+                    module_mark(impp, MODULE_MARK_NEEDED);
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < ih->table_index; ++i) {
+        module_init_info_t *mip = ih->table[i];
+
+        if (module_marks(mip) != 0) {
+            module_mark(mip, 0);
+            *mip->ordinal = n;
+            ih->table[n]  = mip;
+            ++n;
+        }
+    }
+    ih->table_index = n;
+}
+
+
+/* module_handle_eager
+ *
+ *   Removes the lazy modules that are not (transitively) imported by
+ *   a module that is not lazy, and the modules that are already
+ *   initialized, from the sorted 'ih->table'.  See
+ *   module_handle_closure().
+ */
+static inline void
+module_handle_eager(module_init_handle_t *ih)
+{
+    if (module_handle_is_partial(ih)) {
+        module_handle_closure(ih, NULL, 0);
+    }
+}
+
+
+/* module_handle_check_phases
+ *
+ *   Checks that no module in [0, table_index) of the sorted
+ *   'ih->table' has an edge to a module of a later phase.  If one
+ *   does, 'ih->init_state' is set to IR_PHASE, and [0, table_index)
+ *   holds the module, followed by the module of the later phase; no
+ *   module is left marked.
+ */
+static inline void
+module_handle_check_phases(module_init_handle_t *ih)
+{
+    unsigned i;
+
+    for (i = 0; i < ih->table_index; ++i) {
+        module_init_info_t *mip = ih->table[i];
+        unsigned            e;
+
+        for (e = 0; e < module_n_edges(mip); ++e) {
+            module_init_info_t *impp = module_edge(mip, e);
+
+            if (impp != NULL && impp->phase > mip->phase) {
+                module_handle_unmark(ih, 0, ih->table_index);
+                if (module_handle_writable(ih)) {
+                    ih->init_state  = IR_PHASE;
+                    ih->table[0]    = mip;
+                    ih->table[1]    = impp;
+                    ih->table_index = 2;
+                }
+                return;
             }
-            ih->table[ih->table_index]->init_state = IS_INITIALIZED;
         }
+    }
+}
+
+
+/* module_handle_sort
+ *
+ *   This function prepares 'ih' to initialize modules with 'options',
+ *   and topologically sorts all the modules in the program into
+ *   'ih->table'.  If a precomputed order is available, it is used
+ *   instead.
+ *
+ *   When 'ih->init_state' is IR_SUCCESS on return, [0, table_index)
+ *   of 'ih->table' contains all modules that are not yet initialized
+ *   (all modules, with a precomputed order) in an order suitable for
+ *   sequential initialization, and ordered by phase.  Otherwise, no
+ *   module should be initialized.  module_init_lock must be held.
+ */
+static inline int
+module_handle_prepare(module_init_handle_t *ih, unsigned options);
+
+static inline void
+module_handle_sort(module_init_handle_t *ih, unsigned options)
+{
+    if (!module_handle_prepare(ih, options) &&
+        ih->init_state == IR_SUCCESS) {
+        topological_sort_modules(ih);
+    }
+    if (ih->init_state == IR_SUCCESS) {
+        module_handle_check_phases(ih);
+    }
+}
+
+
+/* module_handle_prepare
+ *
+ *   Prepares 'ih' to initialize modules with 'options'.  If a
+ *   precomputed order is available, it becomes 'ih->table', and
+ *   non-zero is returned.  Otherwise, 'ih->table' is empty, and zero
+ *   is returned.  In either case, 'ih->init_state' is IR_MEMORY if
+ *   memory could not be allocated.
+ */
+static inline int
+module_handle_prepare(module_init_handle_t *ih, unsigned options)
+{
+    const int precomputed = module_handle_precomputed(ih);
+
+    if (!precomputed) {
+        if (options & MO_STATIC_TABLE) {
+            module_handle_initialize_static(ih);
+        }
+        if ((options & MO_STATIC_TABLE) == 0 || ih->table == NULL) {
+            module_handle_initialize(ih, LINKERSET_SIZE(module_init_info,
+                                                        unsigned));
+        }
+        if (ih->table == NULL) {
+            ih->init_state = IR_MEMORY;
+            return 0;
+        }
+    }
+
+    ih->options = options;
+    if (options & (MO_TIMING | MO_MEMORY)) {
+        ih->timing = calloc(ih->table_size, sizeof(module_timing_t));
+        if (ih->timing == NULL) {
+            ih->init_state = IR_MEMORY;
+            return precomputed;
+        }
+        ih->timing_epoch_ns = module_clock_ns(CLOCK_MONOTONIC);
+    }
+    return precomputed;
+}
+
+
+/* module_initialize_sorted
+ *
+ *   Initializes the first 'n' modules of the sorted 'ih->table', in
+ *   order, stopping at the first that fails.  Modules that are not
+ *   initialized are left unmarked, and, if one failed, canceled.
+ *   module_init_lock must be held.
+ */
+static inline void
+module_initialize_sorted(module_init_handle_t *ih, unsigned n)
+{
+    ih->table_index = 0;
+    while (ih->table_index < n) {
+        module_init_info_t *mip = ih->table[ih->table_index];
+        int                 init_result;
+
+        module_set_state(mip, IS_INITIALIZING);
+        init_result = module_init_call(ih, mip,
+                                       (ih->timing != NULL
+                                        ? &ih->timing[ih->table_index]
+                                        : NULL),
+                                       &ih->timing_child_ns);
+        if (init_result != 0) {
+            module_arena_release(module_impl(mip));
+            module_set_state(mip, IS_UNINITIALIZED);
+            module_handle_unmark(ih, ih->table_index + 1, n);
+            module_handle_cancel(ih, ih->table_index, n);
+            ih->init_state = IR_FAILED;
+            return;
+        }
+        module_set_state(mip, IS_INITIALIZED);
         ++ih->table_index;
     }
 
-    assert(ih->table_index == ih->table_size);
+    /* A second handle, used by a caller that found the modules
+     * initialized, does not replace the first.
+     */
+    if (module_init_lazy_handle == NULL) {
+        module_init_lazy_handle = ih;
+    }
+}
+
+
+/* module_initialization
+ *
+ *   This function processes the module_init_info linkerset, invoking
+ *   the initialization functions of all declared modules, except lazy
+ *   modules that no other module needs.
+ *
+ *   On return, 'ih->init_state' is:
+ *
+ *     IR_SUCCESS: All modules were initialized.  [0, table_index) of
+ *                 'ih->table' holds them in the order they were
+ *                 initialized.
+ *
+ *     IR_CYCLE:   No module was initialized.  [0, table_index) of
+ *                 'ih->table' holds the modules of the cycle.
+ *
+ *     IR_FAILED:  The module at 'ih->table[ih->table_index]' failed
+ *                 to initialize.  [0, table_index) holds the modules
+ *                 that were initialized.
+ *
+ *     IR_MEMORY:  No module was initialized.
+ *
+ *     IR_PHASE:   No module was initialized.  [0, table_index) of
+ *                 'ih->table' holds a module, and the module of a
+ *                 later phase that it imports.
+ *
+ *   Lazy modules that are initialized later, with
+ *   MODULE_ENSURE_INITIALIZED(), are appended to [0, table_index).
+ *   Unless the result is IR_CYCLE, IR_MEMORY or IR_PHASE,
+ *   module_finalization() should be used to finalize exactly the
+ *   modules that were initialized.
+ *
+ *   Modules are only initialized once.  If modules are already
+ *   initialized, by an earlier call or by another thread, they are
+ *   skipped, and are not recorded in 'ih'.  A call made while another
+ *   thread is initializing modules waits for it; see
+ *   module_init_lock.
+ *
+ *   'options' is a bitwise-or of module_init_option_t values.
+ */
+static inline void
+module_initialization_until_with(module_init_handle_t *ih,
+                                 module_phase_t        last,
+                                 unsigned              options);
+
+static inline void
+module_initialization_with(module_init_handle_t *ih, unsigned options)
+{
+    module_initialization_until_with(ih, MP_BACKGROUND, options);
+}
+
+
+/* module_initialization
+ *
+ *   Initializes all modules with no options.  See
+ *   module_initialization_with().
+ */
+static inline void
+module_initialization(module_init_handle_t *ih)
+{
+    module_initialization_with(ih, 0);
+}
+
+
+/* module_handle_defer
+ *
+ *   Moves the modules of the phases after 'last' from [0, table_index)
+ *   of the sorted 'ih->table' to 'ih->pending', keeping their order,
+ *   and unmarks them.  Both sets remain in an order suitable for
+ *   sequential initialization, because no module imports one of a
+ *   later phase.  'ih->init_state' is set to IR_MEMORY if memory
+ *   could not be allocated.
+ */
+static inline void
+module_handle_defer(module_init_handle_t *ih, module_phase_t last)
+{
+    unsigned n_pending = 0;
+    unsigned n         = 0;
+    unsigned i;
+
+    for (i = 0; i < ih->table_index; ++i) {
+        if (ih->table[i]->phase > last) {
+            ++n_pending;
+        }
+    }
+    if (n_pending == 0) {
+        return;
+    }
+
+    ih->pending = calloc(n_pending, sizeof(module_init_info_t *));
+    if (ih->pending == NULL || !module_handle_writable(ih)) {
+        module_handle_unmark(ih, 0, ih->table_index);
+        ih->init_state = IR_MEMORY;
+        return;
+    }
+
+    for (i = 0; i < ih->table_index; ++i) {
+        module_init_info_t *mip = ih->table[i];
+
+        if (mip->phase > last) {
+            module_mark(mip, 0);
+            ih->pending[ih->pending_size] = mip;
+            ++ih->pending_size;
+        } else {
+            *mip->ordinal = n;
+            ih->table[n]  = mip;
+            ++n;
+        }
+    }
+    ih->table_index = n;
+}
+
+
+/* module_initialization_until_with
+ *
+ *   As module_initialization_with(), but only the modules of phase
+ *   'last' and the earlier phases are initialized before it returns.
+ *   The modules of the later phases are kept in 'ih->pending'; they
+ *   are initialized by module_initialization_pending(), which may be
+ *   called on another thread, or, earlier, on demand with
+ *   MODULE_ENSURE_INITIALIZED().
+ *
+ *   The results are those of module_initialization_with(), for the
+ *   modules that are initialized.  An import of a module of a later
+ *   phase is found whatever 'last' is.
+ */
+static inline void
+module_initialization_until_with(module_init_handle_t *ih,
+                                 module_phase_t        last,
+                                 unsigned              options)
+{
+    module_init_lock_acquire();
+    module_handle_sort(ih, options);
+    if (ih->init_state == IR_SUCCESS) {
+        module_handle_eager(ih);
+    }
+    if (ih->init_state == IR_SUCCESS && last < MP_BACKGROUND) {
+        module_handle_defer(ih, last);
+    }
+    if (ih->init_state == IR_SUCCESS) {
+        /* [0, table_index) of ih->table now contains a set of modules
+         * that is in an order suitable for sequential initialization.
+         *
+         * The original linkerset is unchanged.
+         */
+        module_initialize_sorted(ih, ih->table_index);
+    }
+    module_init_lock_release();
+}
+
+
+/* module_initialization_until
+ *
+ *   Initializes the modules of phase 'last', and of the earlier
+ *   phases, with no options.  See module_initialization_until_with().
+ */
+static inline void
+module_initialization_until(module_init_handle_t *ih, module_phase_t last)
+{
+    module_initialization_until_with(ih, last, 0);
+}
+
+
+/* module_initialization_pending
+ *
+ *   Initializes the modules that module_initialization_until() left
+ *   pending, in order, and returns 'ih->init_state'.  They are
+ *   appended to [0, table_index) of 'ih->table', as modules
+ *   initialized on demand are, so module_finalization() finalizes
+ *   them with the others.
+ *
+ *   module_init_lock is taken for one module at a time, so other
+ *   threads can initialize modules on demand, including pending
+ *   ones, meanwhile.  It stops at the first module that fails, as
+ *   module_initialize_closure() does.
+ *
+ *   'ih' must not be finalized until this function has returned.
+ */
+static inline initialization_result_t
+module_initialization_pending(module_init_handle_t *ih)
+{
+    initialization_result_t result;
+
+    module_init_lock_acquire();
+    while (ih->init_state == IR_SUCCESS &&
+           ih->pending_index < ih->pending_size) {
+        module_init_info_t *mip = ih->pending[ih->pending_index];
+
+        ++ih->pending_index;
+        module_initialize_closure(ih, mip);
+
+        /* Let the threads that are waiting for the lock in. */
+        module_init_lock_release();
+        module_init_lock_acquire();
+    }
+    result = ih->init_state;
+    module_init_lock_release();
+    return result;
+}
+
+
+/* module_initialization_roots_with
+ *
+ *   Initializes only the 'n_roots' modules in 'roots' and the modules
+ *   they transitively import, in dependency order.  Other modules,
+ *   lazy or not, are left uninitialized; they can still be
+ *   initialized with MODULE_ENSURE_INITIALIZED().
+ *
+ *   Only the modules reachable from the roots, through imports and
+ *   ordering-only edges, are visited, so the cost does not depend on
+ *   the number of other modules linked into the program.
+ *
+ *   The results are those of module_initialization_with(), for the
+ *   modules that are initialized, and module_finalization()
+ *   finalizes exactly those modules.  A cycle is only found if it is
+ *   among the imports of the roots.
+ */
+static inline void
+module_initialization_roots_with(module_init_handle_t      *ih,
+                                 module_init_info_t *const *roots,
+                                 unsigned                   n_roots,
+                                 unsigned                   options)
+{
+    unsigned i;
+
+    module_init_lock_acquire();
+    if (!module_handle_prepare(ih, options)) {
+        for (i = 0; i < n_roots && ih->init_state == IR_SUCCESS; ++i) {
+            topological_sort_module(ih, roots[i]);
+        }
+    }
+    if (ih->init_state == IR_SUCCESS) {
+        /* The sort follows ordering-only edges too; the closure drops
+         * the modules that were only reached by them.
+         */
+        module_handle_closure(ih, roots, n_roots);
+    }
+    if (ih->init_state == IR_SUCCESS) {
+        module_initialize_sorted(ih, ih->table_index);
+    }
+    module_init_lock_release();
+}
+
+
+/* module_initialization_roots
+ *
+ *   Initializes the 'n_roots' modules in 'roots', and their imports,
+ *   with no options.  See module_initialization_roots_with().
+ */
+static inline void
+module_initialization_roots(module_init_handle_t      *ih,
+                            module_init_info_t *const *roots,
+                            unsigned                   n_roots)
+{
+    module_initialization_roots_with(ih, roots, n_roots, 0);
+}
+
+
+/* module_find
+ *
+ *   Returns the module named 'name', or NULL, so that the roots of
+ *   module_initialization_roots() can be chosen at run time.
+ */
+static inline module_init_info_t *
+module_find(const char *name)
+{
+    LINKERSET_ITERATE(module_init_info, mi, {
+            if (strcmp(mi->module_name, name) == 0) {
+                return mi;
+            }
+        });
+    return NULL;
 }
 
 
+/* module_finalization
+ *
+ *   Finalizes the modules recorded in 'ih', in the reverse of the
+ *   order they were initialized.  Each module that is finalized, or
+ *   that has no finalization function, returns to IS_UNINITIALIZED,
+ *   so it can be initialized again.
+ */
 static inline void
 module_finalization(module_init_handle_t *ih)
 {
     if (ih->table != NULL) {
         /* ih->table != NULL -> finalization not done. */
 
-        do {
+        module_init_lock_acquire();
+        if (ih->table_index > ih->timing_count) {
+            ih->timing_count = ih->table_index;
+        }
+
+        while (ih->table_index != 0) {
+            module_init_info_t *mip = ih->table[ih->table_index - 1];
+
             --ih->table_index;
 
-            if (ih->table[ih->table_index]->fina_fn != NULL) {
+            if (module_impl(mip)->fina_fn != NULL) {
                 int init_result;
 
-                init_result= ih->table[ih->table_index]->fina_fn();
+                init_result= module_call(ih, module_impl(mip)->fina_fn,
+                                         (ih->timing != NULL
+                                          ? &ih->timing[ih->table_index].fina
+                                          : NULL),
+                                         &ih->timing_child_ns);
                 if (init_result != 0) {
                     /* Finalizing a module failed.  Stop finalizing
                      * lower-level modules because the one that failed
@@ -421,11 +3160,13 @@ module_finalization(module_init_handle_t *ih)
                      * finalization of the whole program.
                      */
                     ih->init_state = IR_FAILED;
-                    return;
+                    break;
                 }
             }
-        } while (ih->table_index != 0);
-
+            module_arena_release(module_impl(mip));
+            module_set_state(mip, IS_UNINITIALIZED);
+        }
+        module_init_lock_release();
     }
 }
 
@@ -0,0 +1,370 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * This header provides a cache, kept in a directory, of the blobs of
+ * cacheable modules (see module_cache_fn_t in module_init.h).
+ *
+ * Each module's blob is kept in its own file, '<module name>.blob',
+ * together with the ELF build-id of the executable or shared object
+ * that contains the module, and the fingerprint of the module's
+ * inputs.  A blob is only used if both match, so rebuilding the
+ * program, or changing the inputs, invalidates it.  Blobs are mapped
+ * read-only into memory; they are not copied.
+ *
+ * Modules in an object that was linked without a build-id
+ * ('--build-id' is the default of most toolchains) are not cached.
+ *
+ * dl_iterate_phdr() is a GNU extension, so programs using this header
+ * must define _GNU_SOURCE before including any system header.
+ */
+#if !defined(MODULE_INIT_CACHE_H_)
+#define MODULE_INIT_CACHE_H_
+
+#if !defined(_GNU_SOURCE)
+#error "module_init_cache.h requires _GNU_SOURCE"
+#endif
+
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "module_init.h"
+
+#define MODULE_CACHE_MAGIC        "MODBLOB1"
+#define MODULE_CACHE_BUILD_ID_MAX 64
+#define MODULE_CACHE_DATA_OFFSET  128
+
+/* module_cache_header_t
+ *
+ *  The start of each blob file.  The blob follows at
+ *  MODULE_CACHE_DATA_OFFSET.
+ */
+typedef struct module_cache_header_t {
+    char     magic[8];
+    uint64_t fingerprint;
+    uint64_t size;
+    uint32_t build_id_size;
+    uint8_t  build_id[MODULE_CACHE_BUILD_ID_MAX];
+} module_cache_header_t;
+
+_Static_assert(sizeof(module_cache_header_t) <= MODULE_CACHE_DATA_OFFSET,
+               "blob cache header overlaps the blob");
+
+
+/* module_mapping_t
+ *
+ *  A blob file mapped into memory.
+ */
+typedef struct module_mapping_t {
+    void   *addr;
+    size_t  size;
+} module_mapping_t;
+
+
+/* module_disk_cache_t
+ *
+ *  cache:
+ *
+ *    The module_cache_t interface; it must be first.
+ *
+ *  directory:
+ *
+ *    The directory holding the blob files.  It is not copied.
+ *
+ *  mappings, n_mappings, max_mappings:
+ *
+ *    The blob files that have been mapped.  Slots are claimed
+ *    atomically, so blobs can be loaded concurrently.  There is one
+ *    slot per module; a blob that does not fit is not used.
+ */
+typedef struct module_disk_cache_t {
+    module_cache_t    cache;
+    const char       *directory;
+    module_mapping_t *mappings;
+    unsigned          n_mappings;
+    unsigned          max_mappings;
+} module_disk_cache_t;
+
+
+/* module_build_id_t
+ *
+ *  Internal type.  The state of the search for the build-id of the
+ *  object containing 'addr'.
+ */
+typedef struct module_build_id_t {
+    uintptr_t      addr;
+    const uint8_t *build_id;
+    uint32_t       size;
+} module_build_id_t;
+
+
+static inline int
+module_build_id_callback(struct dl_phdr_info *info, size_t size, void *arg)
+{
+    module_build_id_t *bid      = (module_build_id_t *)arg;
+    int                contains = 0;
+    unsigned           i;
+
+    (void)size;
+    for (i = 0; i < info->dlpi_phnum; ++i) {
+        const ElfW(Phdr) *ph    = &info->dlpi_phdr[i];
+        uintptr_t         start = info->dlpi_addr + ph->p_vaddr;
+
+        if (ph->p_type == PT_LOAD &&
+            bid->addr >= start && bid->addr - start < ph->p_memsz) {
+            contains = 1;
+            break;
+        }
+    }
+    if (!contains) {
+        return 0;
+    }
+
+    for (i = 0; i < info->dlpi_phnum; ++i) {
+        const ElfW(Phdr) *ph = &info->dlpi_phdr[i];
+        const uint8_t    *p;
+        const uint8_t    *end;
+
+        if (ph->p_type != PT_NOTE) {
+            continue;
+        }
+
+        p   = (const uint8_t *)(info->dlpi_addr + ph->p_vaddr);
+        end = p + ph->p_memsz;
+        while (p + sizeof(ElfW(Nhdr)) <= end) {
+            const ElfW(Nhdr) *note = (const ElfW(Nhdr) *)p;
+            const uint8_t    *name = p + sizeof(ElfW(Nhdr));
+            const uint8_t    *desc = name + ((note->n_namesz + 3) & ~3u);
+
+            if (note->n_type == NT_GNU_BUILD_ID &&
+                note->n_namesz == 4 && memcmp(name, "GNU", 4) == 0 &&
+                note->n_descsz <= MODULE_CACHE_BUILD_ID_MAX) {
+                bid->build_id = desc;
+                bid->size     = note->n_descsz;
+                return 1;
+            }
+            p = desc + ((note->n_descsz + 3) & ~3u);
+        }
+    }
+    return 1;                   /* Found the object; it has no build-id. */
+}
+
+
+/* module_build_id
+ *
+ *   Finds the build-id of the loaded object that contains 'mip'.
+ *   Returns its size, or zero if it has none.
+ */
+static inline uint32_t
+module_build_id(const module_init_info_t *mip, const uint8_t **build_id)
+{
+    module_build_id_t bid = { (uintptr_t)mip, NULL, 0 };
+
+    dl_iterate_phdr(module_build_id_callback, &bid);
+    *build_id = bid.build_id;
+    return bid.size;
+}
+
+
+static inline int
+module_disk_cache_path(const module_disk_cache_t *dc,
+                       const module_init_info_t  *mip,
+                       char                      *path,
+                       size_t                     size)
+{
+    int len = snprintf(path, size, "%s/%s.blob",
+                       dc->directory, mip->module_name);
+
+    return len > 0 && (size_t)len < size;
+}
+
+
+static inline int
+module_disk_cache_load(module_cache_t     *cache,
+                       module_init_info_t *mip,
+                       uint64_t            fingerprint,
+                       module_blob_t      *blob)
+{
+    module_disk_cache_t         *dc = (module_disk_cache_t *)cache;
+    const module_cache_header_t *header;
+    const uint8_t               *build_id;
+    uint32_t                     build_id_size;
+    char                         path[4096];
+    struct stat                  st;
+    void                        *addr;
+    unsigned                     slot;
+    int                          fd;
+
+    build_id_size = module_build_id(mip, &build_id);
+    if (build_id_size == 0 ||
+        !module_disk_cache_path(dc, mip, path, sizeof(path))) {
+        return 1;
+    }
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < MODULE_CACHE_DATA_OFFSET) {
+        close(fd);
+        return 1;
+    }
+    addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return 1;
+    }
+
+    header = (const module_cache_header_t *)addr;
+    if (memcmp(header->magic, MODULE_CACHE_MAGIC, sizeof(header->magic)) ||
+        header->fingerprint != fingerprint ||
+        header->size != (uint64_t)st.st_size - MODULE_CACHE_DATA_OFFSET ||
+        header->build_id_size != build_id_size ||
+        memcmp(header->build_id, build_id, build_id_size) != 0) {
+        munmap(addr, st.st_size);
+        return 1;
+    }
+
+    slot = __atomic_fetch_add(&dc->n_mappings, 1, __ATOMIC_RELAXED);
+    if (slot >= dc->max_mappings) {
+        munmap(addr, st.st_size);
+        return 1;
+    }
+    dc->mappings[slot].addr = addr;
+    dc->mappings[slot].size = st.st_size;
+
+    blob->data = (const uint8_t *)addr + MODULE_CACHE_DATA_OFFSET;
+    blob->size = header->size;
+    return 0;
+}
+
+
+/* module_disk_cache_store
+ *
+ *   Writes the blob to a temporary file, which is renamed over the
+ *   blob file, so a reader never sees a partial blob.
+ */
+static inline void
+module_disk_cache_store(module_cache_t      *cache,
+                        module_init_info_t  *mip,
+                        uint64_t             fingerprint,
+                        const module_blob_t *blob)
+{
+    module_disk_cache_t   *dc = (module_disk_cache_t *)cache;
+    module_cache_header_t  header;
+    const uint8_t         *build_id;
+    char                   path[4096];
+    char                   tmp[4096 + 32];
+    FILE                  *fp;
+    int                    ok;
+
+    memset(&header, 0, sizeof(header));
+    header.build_id_size = module_build_id(mip, &build_id);
+    if (header.build_id_size == 0 ||
+        !module_disk_cache_path(dc, mip, path, sizeof(path))) {
+        return;
+    }
+    memcpy(header.magic, MODULE_CACHE_MAGIC, sizeof(header.magic));
+    memcpy(header.build_id, build_id, header.build_id_size);
+    header.fingerprint = fingerprint;
+    header.size        = blob->size;
+
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+    fp = fopen(tmp, "wb");
+    if (fp == NULL) {
+        return;
+    }
+
+    ok = (fwrite(&header, sizeof(header), 1, fp) == 1 &&
+          fseek(fp, MODULE_CACHE_DATA_OFFSET, SEEK_SET) == 0 &&
+          (blob->size == 0 ||
+           fwrite(blob->data, blob->size, 1, fp) == 1));
+    ok = fclose(fp) == 0 && ok;
+
+    if (!ok || rename(tmp, path) != 0) {
+        unlink(tmp);
+    }
+}
+
+
+/* module_disk_cache_open
+ *
+ *   Makes 'dc', kept in 'directory', the program's module_init_cache.
+ *   The directory must exist.  Returns non-zero if memory could not be
+ *   allocated.
+ */
+static inline int
+module_disk_cache_open(module_disk_cache_t *dc, const char *directory)
+{
+    dc->cache.load    = module_disk_cache_load;
+    dc->cache.store   = module_disk_cache_store;
+    dc->directory     = directory;
+    dc->n_mappings    = 0;
+    dc->max_mappings  = LINKERSET_SIZE(module_init_info, unsigned);
+    dc->mappings      = calloc(dc->max_mappings + 1, sizeof(module_mapping_t));
+    if (dc->mappings == NULL) {
+        return 1;
+    }
+
+    module_init_cache = &dc->cache;
+    return 0;
+}
+
+
+/* module_disk_cache_close
+ *
+ *   Unmaps all blobs; it must be used only after the modules using
+ *   them have been finalized.
+ */
+static inline void
+module_disk_cache_close(module_disk_cache_t *dc)
+{
+    unsigned n = dc->n_mappings;
+    unsigned i;
+
+    if (n > dc->max_mappings) {
+        n = dc->max_mappings;
+    }
+    for (i = 0; i < n; ++i) {
+        munmap(dc->mappings[i].addr, dc->mappings[i].size);
+    }
+    free(dc->mappings);
+    dc->mappings   = NULL;
+    dc->n_mappings = 0;
+
+    if (module_init_cache == &dc->cache) {
+        module_init_cache = NULL;
+    }
+}
+
+#endif
@@ -0,0 +1,389 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * This header finds every import cycle among the modules of a
+ * program.
+ *
+ * When module initialization finds a cycle, it stops at the first
+ * one, and reports only the modules on that path.  Fixing cycles one
+ * at a time means relinking once per cycle.  module_find_cycles()
+ * instead finds the strongly connected components of the whole
+ * IMPORT() graph, ordering-only edges included, using Tarjan's
+ * algorithm, in time linear in the number of modules and imports.
+ * Every component with more than one module, or with a module that
+ * imports itself, contains a cycle; every module in such a component
+ * is on at least one cycle.
+ */
+#if !defined(MODULE_INIT_CYCLES_H_)
+#define MODULE_INIT_CYCLES_H_
+
+#include <limits.h>
+#include <stdio.h>
+#include "module_init.h"
+
+/* module_cycle_report_t
+ *
+ *  n_components:
+ *
+ *    The number of strongly connected components that contain a
+ *    cycle.
+ *
+ *  modules, component:
+ *
+ *    The modules of component 'c' are
+ *
+ *      modules[component[c] .. component[c + 1])
+ *
+ *    'component' has 'n_components' + 1 elements.
+ *
+ *  edges, edge_start:
+ *
+ *    The edges of 'modules[i]' to modules of its own component, which
+ *    are the edges that form its cycles, are
+ *
+ *      module_edge(modules[i], edges[k])
+ *
+ *    for 'k' in [edge_start[i], edge_start[i + 1]).
+ */
+typedef struct module_cycle_report_t {
+    unsigned              n_components;
+    module_init_info_t  **modules;
+    unsigned             *component;
+    unsigned             *edges;
+    unsigned             *edge_start;
+} module_cycle_report_t;
+
+
+static inline void
+module_cycle_report_free(module_cycle_report_t *report)
+{
+    free(report->modules);
+    free(report->component);
+    free(report->edges);
+    free(report->edge_start);
+    report->n_components = 0;
+    report->modules      = NULL;
+    report->component    = NULL;
+    report->edges        = NULL;
+    report->edge_start   = NULL;
+}
+
+
+/* module_cycle_edges
+ *
+ *   Stores, in 'report', the edges of each module of a component to
+ *   the modules of the same component.  'found' is the index in
+ *   'report->modules' of the module at each linkerset position, or
+ *   UINT_MAX, and the 'ordinal' of each module is its position.
+ *   Returns non-zero if memory could not be allocated.
+ */
+static inline int
+module_cycle_edges(module_cycle_report_t *report,
+                   const unsigned        *found)
+{
+    const unsigned n_found = report->component[report->n_components];
+    unsigned       c;
+    unsigned       k = 0;
+    unsigned       pass;
+
+    report->edge_start = calloc(n_found + 1, sizeof(unsigned));
+    if (report->edge_start == NULL) {
+        return 1;
+    }
+
+    /* The first pass counts the edges, the second stores them. */
+    for (pass = 0; pass < 2; ++pass) {
+        if (pass == 1) {
+            report->edges = calloc(k + 1, sizeof(unsigned));
+            if (report->edges == NULL) {
+                return 1;
+            }
+            k = 0;
+        }
+        for (c = 0; c < report->n_components; ++c) {
+            const unsigned first = report->component[c];
+            const unsigned last  = report->component[c + 1];
+            unsigned       i;
+
+            for (i = first; i < last; ++i) {
+                module_init_info_t *mip = report->modules[i];
+                unsigned            e;
+
+                report->edge_start[i] = k;
+                for (e = 0; e < module_n_edges(mip); ++e) {
+                    module_init_info_t *impp = module_edge(mip, e);
+                    unsigned            j;
+
+                    if (impp == NULL) {
+                        continue;
+                    }
+                    j = found[*impp->ordinal];
+                    if (j != UINT_MAX && j >= first && j < last) {
+                        if (pass == 1) {
+                            report->edges[k] = e;
+                        }
+                        ++k;
+                    }
+                }
+            }
+        }
+    }
+    report->edge_start[n_found] = k;
+    return 0;
+}
+
+
+static inline int
+module_imports_self(module_init_info_t *mip)
+{
+    unsigned e;
+
+    for (e = 0; e < module_n_edges(mip); ++e) {
+        if (module_edge(mip, e) == mip) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/* module_find_cycles
+ *
+ *   Finds all import cycles among the modules in the module_init_info
+ *   linkerset, and stores them in 'report', which must be released
+ *   with module_cycle_report_free().
+ *
+ *   The search is not recursive; the depth-first traversal keeps an
+ *   explicit stack.  While it runs, module_init_lock is held, and
+ *   each module's 'ordinal' holds its position in the linkerset; the
+ *   ordinals are restored before it returns.  It may be called at any
+ *   time, including after MODULE_ENSURE_INITIALIZED() has returned
+ *   IR_CYCLE in a program whose other modules are initialized.
+ *
+ *   The result is IR_SUCCESS if there are no cycles, IR_CYCLE if
+ *   there are, and IR_MEMORY if memory could not be allocated.
+ */
+static inline initialization_result_t
+module_find_cycles(module_cycle_report_t *report)
+{
+    const unsigned       n       = LINKERSET_SIZE(module_init_info, unsigned);
+    module_init_info_t **modules = LINKERSET_START(module_init_info);
+    unsigned            *index;    /* Visit order, or UINT_MAX. */
+    unsigned            *low;      /* Tarjan's low-link. */
+    unsigned            *scc;      /* Stack of the current components. */
+    unsigned            *frame;    /* Depth-first stack of modules. */
+    unsigned            *cursor;   /* Next import of each frame. */
+    unsigned            *saved;    /* The ordinals of the modules. */
+    unsigned            *found;    /* Index in 'report->modules'. */
+    unsigned char       *on_scc;
+    int                  failed    = 0;
+    unsigned             n_visited = 0;
+    unsigned             scc_top   = 0;
+    unsigned             n_found   = 0;
+    unsigned             r;
+
+    report->n_components = 0;
+    report->edges        = NULL;
+    report->edge_start   = NULL;
+    report->modules      = calloc(n + 1, sizeof(module_init_info_t *));
+    report->component    = calloc(n + 1, sizeof(unsigned));
+    index                = calloc(n + 1, sizeof(unsigned));
+    low                  = calloc(n + 1, sizeof(unsigned));
+    scc                  = calloc(n + 1, sizeof(unsigned));
+    frame                = calloc(n + 1, sizeof(unsigned));
+    cursor               = calloc(n + 1, sizeof(unsigned));
+    saved                = calloc(n + 1, sizeof(unsigned));
+    found                = calloc(n + 1, sizeof(unsigned));
+    on_scc               = calloc(n + 1, sizeof(unsigned char));
+
+    if (report->modules == NULL || report->component == NULL ||
+        index == NULL || low == NULL || scc == NULL ||
+        frame == NULL || cursor == NULL || saved == NULL ||
+        found == NULL || on_scc == NULL) {
+        free(index);
+        free(low);
+        free(scc);
+        free(frame);
+        free(cursor);
+        free(saved);
+        free(found);
+        free(on_scc);
+        module_cycle_report_free(report);
+        return IR_MEMORY;
+    }
+
+    module_init_lock_acquire();
+    for (r = 0; r < n; ++r) {
+        saved[r]             = *modules[r]->ordinal;
+        *modules[r]->ordinal = r;
+        index[r]             = UINT_MAX;
+        found[r]             = UINT_MAX;
+    }
+
+    for (r = 0; r < n; ++r) {
+        unsigned depth = 0;
+
+        if (index[r] != UINT_MAX) {
+            continue;
+        }
+
+        frame[depth]  = r;
+        cursor[depth] = 0;
+        ++depth;
+        index[r]      = n_visited;
+        low[r]        = n_visited;
+        ++n_visited;
+        scc[scc_top]  = r;
+        ++scc_top;
+        on_scc[r]     = 1;
+
+        while (depth != 0) {
+            const unsigned v = frame[depth - 1];
+
+            if (cursor[depth - 1] < module_n_edges(modules[v])) {
+                module_init_info_t *impp = module_edge(modules[v],
+                                                       cursor[depth - 1]);
+                unsigned            w;
+
+                ++cursor[depth - 1];
+                if (impp == NULL) {
+                    continue;
+                }
+
+                w = *impp->ordinal;
+                if (index[w] == UINT_MAX) {
+                    frame[depth]  = w;
+                    cursor[depth] = 0;
+                    ++depth;
+                    index[w]      = n_visited;
+                    low[w]        = n_visited;
+                    ++n_visited;
+                    scc[scc_top]  = w;
+                    ++scc_top;
+                    on_scc[w]     = 1;
+                } else if (on_scc[w] && index[w] < low[v]) {
+                    low[v] = index[w];
+                }
+            } else {
+                --depth;
+                if (depth != 0 && low[v] < low[frame[depth - 1]]) {
+                    low[frame[depth - 1]] = low[v];
+                }
+
+                if (low[v] == index[v]) {
+                    /* 'v' is the root of a component, which is the
+                     * top of 'scc' down to 'v'.
+                     */
+                    const unsigned first = n_found;
+                    unsigned       w;
+
+                    do {
+                        --scc_top;
+                        w         = scc[scc_top];
+                        on_scc[w] = 0;
+                        report->modules[n_found] = modules[w];
+                        found[w]                 = n_found;
+                        ++n_found;
+                    } while (w != v);
+
+                    if (n_found - first > 1 ||
+                        module_imports_self(modules[v])) {
+                        report->component[report->n_components] = first;
+                        ++report->n_components;
+                    } else {
+                        found[v] = UINT_MAX;
+                        n_found  = first; /* Acyclic; discard. */
+                    }
+                }
+            }
+        }
+    }
+    report->component[report->n_components] = n_found;
+    failed = module_cycle_edges(report, found);
+
+    for (r = 0; r < n; ++r) {
+        *modules[r]->ordinal = saved[r];
+    }
+    module_init_lock_release();
+
+    free(index);
+    free(low);
+    free(scc);
+    free(frame);
+    free(cursor);
+    free(saved);
+    free(found);
+    free(on_scc);
+
+    if (failed) {
+        module_cycle_report_free(report);
+        return IR_MEMORY;
+    }
+    return report->n_components != 0 ? IR_CYCLE : IR_SUCCESS;
+}
+
+
+/* module_cycle_report_print
+ *
+ *   Prints each component of 'report', with the imports between its
+ *   modules, which are the edges that form its cycles.  Only
+ *   'report' is read, so it may be called at any time.
+ */
+static inline void
+module_cycle_report_print(const module_cycle_report_t *report, FILE *fp)
+{
+    unsigned c;
+
+    for (c = 0; c < report->n_components; ++c) {
+        const unsigned first = report->component[c];
+        const unsigned last  = report->component[c + 1];
+        unsigned       i;
+
+        fprintf(fp, "Cycle %u: %u module%s\n",
+                c + 1, last - first, last - first == 1 ? "" : "s");
+
+        for (i = first; i < last; ++i) {
+            module_init_info_t *mip = report->modules[i];
+            unsigned            k;
+
+            fprintf(fp, "  %s\n", mip->module_name);
+            for (k = report->edge_start[i]; k < report->edge_start[i + 1];
+                 ++k) {
+                const unsigned e = report->edges[k];
+
+                fprintf(fp, "    %s: %s\n",
+                        e < module_n_imports(mip) ? "import" : "after",
+                        module_edge(mip, e)->module_name);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,111 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * This header provides a quick exit, which runs only the finalization
+ * functions that must run before the process exits.
+ *
+ * Most finalization functions only free memory, which the kernel
+ * reclaims anyway when the process exits, and finalizing a program
+ * with a large heap can take a long time.  A module whose
+ * finalization function only releases memory is declared with
+ * MF_FINA_MEMORY; one that must run at exit, for example to flush a
+ * log, with MF_FINA_AT_EXIT:
+ *
+ *   DECLARE_MODULE(words, words_init, words_fina, .flags = MF_FINA_MEMORY);
+ *   DECLARE_MODULE(log, log_init, log_flush, .flags = MF_FINA_AT_EXIT);
+ *
+ * module_quick_exit() calls the finalization functions that are not
+ * MF_FINA_MEMORY, in the same order as module_finalization(), and
+ * exits.  When the MODULE_INIT_FULL_EXIT environment variable is set,
+ * for example to run a leak checker, every module is finalized, and
+ * the program exits normally.
+ */
+#if !defined(MODULE_INIT_EXIT_H_)
+#define MODULE_INIT_EXIT_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "module_init.h"
+
+/* module_quick_exit
+ *
+ *   Finalizes the modules recorded in 'ih' whose finalization
+ *   functions are needed at exit, importers first, and terminates the
+ *   process with 'status'.  As with module_finalization(), a
+ *   finalization function that fails stops the finalization of the
+ *   modules it imports.
+ *
+ *   The streams of stdio are flushed, but the process exits with
+ *   _exit(2): functions registered with atexit(3) are not called.
+ *   The modules are not returned to IS_UNINITIALIZED, and module
+ *   arenas are not released.
+ *
+ *   If the MODULE_INIT_FULL_EXIT environment variable is set and not
+ *   empty, module_finalization() finalizes every module instead, and
+ *   the process exits with exit(3).
+ *
+ *   The same conditions apply as to module_finalization(); in
+ *   particular, pending modules must have been initialized.
+ */
+__attribute__((noreturn)) static inline void
+module_quick_exit(module_init_handle_t *ih, int status)
+{
+    const char *full = getenv("MODULE_INIT_FULL_EXIT");
+    unsigned    i;
+
+    if (full != NULL && full[0] != '\0') {
+        module_finalization(ih);
+        module_handle_finalize(ih);
+        exit(status);
+    }
+
+    /* The lock is not released: no module may be initialized on
+     * demand while, or after, they are finalized.
+     */
+    module_init_lock_acquire();
+    for (i = ih->table != NULL ? ih->table_index : 0; i > 0; --i) {
+        module_init_info_t *impl = module_impl(ih->table[i - 1]);
+
+        assert((impl->flags & (MF_FINA_AT_EXIT | MF_FINA_MEMORY)) !=
+               (MF_FINA_AT_EXIT | MF_FINA_MEMORY));
+        if (impl->fina_fn == NULL || (impl->flags & MF_FINA_MEMORY) != 0) {
+            continue;
+        }
+        if (impl->fina_fn() != 0) {
+            break;
+        }
+    }
+
+    fflush(NULL);
+    _exit(status);
+}
+
+#endif
@@ -0,0 +1,525 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * This header analyzes the IMPORT() graph of a program.
+ *
+ * Over time, import lists collect redundant edges: 'a' imports 'b'
+ * and 'c', and 'b' already imports 'c'.  A redundant import does not
+ * change the initialization order, but it costs time to sort and
+ * obscures which modules really depend on each other.
+ * module_analyze_graph() finds them by computing the transitive
+ * reduction of the graph, and measures its shape:
+ *
+ *   depth: The number of modules on the longest chain of imports.
+ *          No schedule, however parallel, initializes the modules in
+ *          fewer steps.
+ *
+ *   width: The largest number of modules at the same level, where a
+ *          module's level is the length of the longest chain of
+ *          imports that it heads.  The modules of a level do not
+ *          import each other, so they can all be initialized at once.
+ *
+ * With modules of equal cost, the modules divided by the depth is
+ * the speedup that parallel initialization can achieve at most.
+ *
+ * The report can be printed, or written as a Graphviz DOT graph or as
+ * JSON for other tools.  Only IMPORT() edges are considered; weak
+ * imports of modules that are not linked, and ordering-only edges,
+ * are ignored.
+ */
+#if !defined(MODULE_INIT_GRAPH_H_)
+#define MODULE_INIT_GRAPH_H_
+
+#include <limits.h>
+#include <stdio.h>
+#include "module_init.h"
+
+/* module_graph_report_t
+ *
+ *  modules:
+ *
+ *    All modules, imports before their importers.
+ *
+ *  level:
+ *
+ *    The level of each module, starting at one for modules that
+ *    import nothing.
+ *
+ *  edge_index, via:
+ *
+ *    The 'e'th import of 'modules[i]' is redundant if
+ *
+ *      via[edge_index[i] + e]
+ *
+ *    is not NULL.  It is then one of the other imports of the module,
+ *    through which the import is already reached, or the import
+ *    itself if it is imported twice.
+ *
+ *  n_imports, n_redundant:
+ *
+ *    The number of imports, and of redundant imports.
+ */
+typedef struct module_graph_report_t {
+    unsigned              n_modules;
+    module_init_info_t  **modules;
+    unsigned             *level;
+    unsigned             *edge_index;
+    module_init_info_t  **via;
+    unsigned              n_imports;
+    unsigned              n_redundant;
+    unsigned              depth;
+    unsigned              width;
+} module_graph_report_t;
+
+
+static inline void
+module_graph_report_free(module_graph_report_t *report)
+{
+    free(report->modules);
+    free(report->level);
+    free(report->edge_index);
+    free(report->via);
+    memset(report, 0, sizeof(*report));
+}
+
+
+/* module_graph_sort
+ *
+ *   Stores the modules of the linkerset in 'report->modules', imports
+ *   first, and sets the 'ordinal' of each to its position there.
+ *   Returns IR_CYCLE if the imports form a cycle.
+ *
+ *   The depth-first traversal keeps an explicit stack.  'color' is
+ *   zero for modules not visited, one for those on the stack, and two
+ *   for those sorted.
+ */
+static inline initialization_result_t
+module_graph_sort(module_graph_report_t *report,
+                  unsigned              *frame,
+                  unsigned              *cursor,
+                  unsigned char         *color)
+{
+    const unsigned       n       = report->n_modules;
+    module_init_info_t **modules = LINKERSET_START(module_init_info);
+    unsigned             n_found = 0;
+    unsigned             r;
+
+    for (r = 0; r < n; ++r) {
+        *modules[r]->ordinal = r;
+    }
+
+    for (r = 0; r < n; ++r) {
+        unsigned depth = 0;
+
+        if (color[r] != 0) {
+            continue;
+        }
+
+        frame[depth]  = r;
+        cursor[depth] = 0;
+        ++depth;
+        color[r]      = 1;
+
+        while (depth != 0) {
+            const unsigned v = frame[depth - 1];
+
+            if (cursor[depth - 1] < module_n_imports(modules[v])) {
+                module_init_info_t *impp = module_edge(modules[v],
+                                                       cursor[depth - 1]);
+                unsigned            w;
+
+                ++cursor[depth - 1];
+                if (impp == NULL) {
+                    continue;
+                }
+
+                w = *impp->ordinal;
+                if (color[w] == 1) {
+                    return IR_CYCLE;
+                } else if (color[w] == 0) {
+                    frame[depth]  = w;
+                    cursor[depth] = 0;
+                    ++depth;
+                    color[w]      = 1;
+                }
+            } else {
+                --depth;
+                color[v]                   = 2;
+                report->modules[n_found] = modules[v];
+                ++n_found;
+            }
+        }
+    }
+    assert(n_found == n);
+
+    for (r = 0; r < n; ++r) {
+        *report->modules[r]->ordinal = r;
+    }
+    return IR_SUCCESS;
+}
+
+
+/* module_graph_reduce
+ *
+ *   Finds the redundant imports, and the level of each module.
+ *
+ *   'reach' holds, for each module, the set of modules it reaches
+ *   through its imports.  A module only reaches modules that precede
+ *   it, so the set of the module at position 'i' has 'i' bits, and
+ *   all the sets take n^2 / 16 bytes.  An import of 'modules[i]' is
+ *   redundant if another of its imports reaches it.  'seen' has a
+ *   bit for each module, and is clear on entry and return.
+ */
+static inline void
+module_graph_reduce(module_graph_report_t  *report,
+                    uint64_t              **reach,
+                    uint64_t               *seen)
+{
+    unsigned i;
+
+    for (i = 0; i < report->n_modules; ++i) {
+        module_init_info_t *mip     = report->modules[i];
+        const unsigned      first   = report->edge_index[i];
+        unsigned            level   = 0;
+        unsigned            e;
+        unsigned            w;
+
+        /* The modules reached through the imports, not counting the
+         * imports themselves.
+         */
+        for (e = 0; e < module_n_imports(mip); ++e) {
+            module_init_info_t *impp = module_edge(mip, e);
+            unsigned            k;
+
+            if (impp == NULL) {
+                continue;
+            }
+            k = *impp->ordinal;
+            for (w = 0; w < (k + 63) / 64; ++w) {
+                reach[i][w] |= reach[k][w];
+            }
+            if (report->level[k] > level) {
+                level = report->level[k];
+            }
+        }
+        report->level[i] = level + 1;
+
+        for (e = 0; e < module_n_imports(mip); ++e) {
+            module_init_info_t *impp = module_edge(mip, e);
+            unsigned            k;
+            unsigned            f;
+
+            if (impp == NULL) {
+                continue;
+            }
+            ++report->n_imports;
+            k = *impp->ordinal;
+
+            if ((seen[k / 64] >> (k % 64)) & 1) {
+                report->via[first + e] = impp;
+            } else if ((reach[i][k / 64] >> (k % 64)) & 1) {
+                for (f = 0; f < module_n_imports(mip); ++f) {
+                    module_init_info_t *other = module_edge(mip, f);
+                    const unsigned      o     = (other != NULL
+                                                 ? *other->ordinal
+                                                 : 0);
+
+                    if (other != NULL && o > k &&
+                        ((reach[o][k / 64] >> (k % 64)) & 1)) {
+                        report->via[first + e] = other;
+                        break;
+                    }
+                }
+            }
+            seen[k / 64] |= (uint64_t)1 << (k % 64);
+            if (report->via[first + e] != NULL) {
+                ++report->n_redundant;
+            }
+        }
+
+        for (e = 0; e < module_n_imports(mip); ++e) {
+            module_init_info_t *impp = module_edge(mip, e);
+
+            if (impp != NULL) {
+                const unsigned k = *impp->ordinal;
+
+                seen[k / 64] &= ~((uint64_t)1 << (k % 64));
+                reach[i][k / 64] |= (uint64_t)1 << (k % 64);
+            }
+        }
+    }
+}
+
+
+/* module_analyze_graph
+ *
+ *   Analyzes the IMPORT() graph of the modules in the module_init_info
+ *   linkerset, and stores the results in 'report', which must be
+ *   released with module_graph_report_free().
+ *
+ *   While it runs, module_init_lock is held and each module's
+ *   'ordinal' is used; the ordinals are restored before it returns.
+ *
+ *   The result is IR_SUCCESS, IR_CYCLE if the imports form a cycle
+ *   (see module_init_cycles.h), or IR_MEMORY if memory could not be
+ *   allocated.
+ */
+static inline initialization_result_t
+module_analyze_graph(module_graph_report_t *report)
+{
+    const unsigned           n       = LINKERSET_SIZE(module_init_info,
+                                                      unsigned);
+    module_init_info_t     **modules = LINKERSET_START(module_init_info);
+    initialization_result_t  result  = IR_MEMORY;
+    unsigned                *saved;    /* The ordinals of the modules. */
+    unsigned                *frame;
+    unsigned                *cursor;
+    unsigned                *count;
+    unsigned char           *color;
+    uint64_t               **reach   = NULL;
+    uint64_t                *seen;
+    int                      restore = 0;
+    unsigned                 i;
+
+    memset(report, 0, sizeof(*report));
+    report->n_modules  = n;
+    report->modules    = calloc(n + 1, sizeof(module_init_info_t *));
+    report->level      = calloc(n + 1, sizeof(unsigned));
+    report->edge_index = calloc(n + 1, sizeof(unsigned));
+    saved              = calloc(n + 1, sizeof(unsigned));
+    frame              = calloc(n + 1, sizeof(unsigned));
+    cursor             = calloc(n + 1, sizeof(unsigned));
+    count              = calloc(n + 2, sizeof(unsigned));
+    color              = calloc(n + 1, sizeof(unsigned char));
+    seen               = calloc(n / 64 + 1, sizeof(uint64_t));
+
+    module_init_lock_acquire();
+    if (report->modules == NULL || report->level == NULL ||
+        report->edge_index == NULL || saved == NULL || frame == NULL ||
+        cursor == NULL || count == NULL || color == NULL || seen == NULL) {
+        goto done;
+    }
+    for (i = 0; i < n; ++i) {
+        saved[i] = *modules[i]->ordinal;
+    }
+    restore = 1;
+
+    result = module_graph_sort(report, frame, cursor, color);
+    if (result != IR_SUCCESS) {
+        goto done;
+    }
+
+    for (i = 0; i < n; ++i) {
+        report->edge_index[i + 1] = (report->edge_index[i] +
+                                     module_n_imports(report->modules[i]));
+    }
+    report->via = calloc(report->edge_index[n] + 1,
+                         sizeof(module_init_info_t *));
+    reach       = calloc(n + 1, sizeof(uint64_t *));
+    result      = IR_MEMORY;
+    if (report->via == NULL || reach == NULL) {
+        goto done;
+    }
+    for (i = 0; i < n; ++i) {
+        reach[i] = calloc((i + 63) / 64 + 1, sizeof(uint64_t));
+        if (reach[i] == NULL) {
+            goto done;
+        }
+    }
+
+    module_graph_reduce(report, reach, seen);
+
+    for (i = 0; i < n; ++i) {
+        ++count[report->level[i]];
+        if (report->level[i] > report->depth) {
+            report->depth = report->level[i];
+        }
+        if (count[report->level[i]] > report->width) {
+            report->width = count[report->level[i]];
+        }
+    }
+    result = IR_SUCCESS;
+
+done:
+    if (restore) {
+        for (i = 0; i < n; ++i) {
+            *modules[i]->ordinal = saved[i];
+        }
+    }
+    module_init_lock_release();
+
+    if (reach != NULL) {
+        for (i = 0; i < n; ++i) {
+            free(reach[i]);
+        }
+    }
+    free(reach);
+    free(saved);
+    free(frame);
+    free(cursor);
+    free(count);
+    free(color);
+    free(seen);
+    if (result != IR_SUCCESS) {
+        module_graph_report_free(report);
+    }
+    return result;
+}
+
+
+/* module_graph_report_print
+ *
+ *   Prints the shape of the graph analyzed in 'report', and each
+ *   redundant import with the import through which it is reached.
+ */
+static inline void
+module_graph_report_print(const module_graph_report_t *report, FILE *fp)
+{
+    unsigned i;
+
+    fprintf(fp, "Modules:           %u\n", report->n_modules);
+    fprintf(fp, "Imports:           %u\n", report->n_imports);
+    fprintf(fp, "Redundant imports: %u\n", report->n_redundant);
+    fprintf(fp, "Depth:             %u\n", report->depth);
+    fprintf(fp, "Width:             %u\n", report->width);
+    if (report->depth != 0) {
+        fprintf(fp, "Parallelism:       %.2f\n",
+                (double)report->n_modules / report->depth);
+    }
+
+    for (i = 0; i < report->n_modules; ++i) {
+        module_init_info_t *mip = report->modules[i];
+        unsigned            e;
+
+        for (e = 0; e < module_n_imports(mip); ++e) {
+            module_init_info_t *via = report->via[report->edge_index[i] + e];
+
+            if (via == NULL) {
+                continue;
+            } else if (via == module_edge(mip, e)) {
+                fprintf(fp, "  %s imports %s more than once\n",
+                        mip->module_name, via->module_name);
+            } else {
+                fprintf(fp, "  %s imports %s, which it reaches through %s\n",
+                        mip->module_name, module_edge(mip, e)->module_name,
+                        via->module_name);
+            }
+        }
+    }
+}
+
+
+/* module_graph_write_dot
+ *
+ *   Writes the graph analyzed in 'report' to 'fp' in the Graphviz DOT
+ *   language.  Each edge points from an importer to its import; the
+ *   redundant ones are dashed.  Module names are C identifiers, so no
+ *   quoting is necessary.
+ *
+ *   Returns zero on success, and non-zero if 'fp' could not be
+ *   written.
+ */
+static inline int
+module_graph_write_dot(const module_graph_report_t *report, FILE *fp)
+{
+    unsigned i;
+
+    fprintf(fp, "digraph imports {\n");
+    for (i = 0; i < report->n_modules; ++i) {
+        module_init_info_t *mip = report->modules[i];
+        unsigned            e;
+
+        fprintf(fp, "    %s;\n", mip->module_name);
+        for (e = 0; e < module_n_imports(mip); ++e) {
+            if (module_edge(mip, e) == NULL) {
+                continue;
+            }
+            fprintf(fp, "    %s -> %s%s;\n",
+                    mip->module_name, module_edge(mip, e)->module_name,
+                    (report->via[report->edge_index[i] + e] != NULL
+                     ? " [style=dashed, color=red]"
+                     : ""));
+        }
+    }
+    fprintf(fp, "}\n");
+
+    return ferror(fp) != 0;
+}
+
+
+/* module_graph_write_json
+ *
+ *   Writes the graph analyzed in 'report' to 'fp' as JSON: its shape,
+ *   and each module with its level and imports.  A redundant import
+ *   has the import it is reached through as "via".
+ *
+ *   Returns zero on success, and non-zero if 'fp' could not be
+ *   written.
+ */
+static inline int
+module_graph_write_json(const module_graph_report_t *report, FILE *fp)
+{
+    unsigned i;
+
+    fprintf(fp, "{\"depth\": %u, \"width\": %u, \"imports\": %u, "
+            "\"redundant\": %u, \"modules\": [",
+            report->depth, report->width,
+            report->n_imports, report->n_redundant);
+    for (i = 0; i < report->n_modules; ++i) {
+        module_init_info_t *mip   = report->modules[i];
+        int                 first = 1;
+        unsigned            e;
+
+        fprintf(fp, "%s\n    {\"name\": \"%s\", \"level\": %u, "
+                "\"imports\": [",
+                i == 0 ? "" : ",", mip->module_name, report->level[i]);
+        for (e = 0; e < module_n_imports(mip); ++e) {
+            module_init_info_t *impp = module_edge(mip, e);
+            module_init_info_t *via  = report->via[report->edge_index[i] + e];
+
+            if (impp == NULL) {
+                continue;
+            }
+            fprintf(fp, "%s{\"name\": \"%s\"", first ? "" : ", ",
+                    impp->module_name);
+            if (via != NULL) {
+                fprintf(fp, ", \"via\": \"%s\"", via->module_name);
+            }
+            fprintf(fp, "}");
+            first = 0;
+        }
+        fprintf(fp, "]}");
+    }
+    fprintf(fp, "\n]}\n");
+
+    return ferror(fp) != 0;
+}
+
+#endif
@@ -0,0 +1,254 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * This header counts the memory allocated by each module's
+ * initialization function, for module_initialization_with() and
+ * module_initialization_parallel_with() with the MO_MEMORY option.
+ *
+ * It defines malloc() and the other allocation functions of the C
+ * library, as well as mmap() and munmap(), so that they are used
+ * instead of the C library's own.  They call the C library, and
+ * charge the size of each block, as given by malloc_usable_size(),
+ * or the length of each mapping, to module_init_memory.  When no
+ * module is being initialized with MO_MEMORY, the only added cost is
+ * one thread-local load.
+ *
+ * Include it in exactly one source file of the program, not of a
+ * shared library.  The definitions are weak, so including it in more
+ * than one is harmless.
+ *
+ * Blocks freed during a call are subtracted from the module whose
+ * function is running, whichever module allocated them.  Mappings
+ * made by the C library itself, for example for large blocks, are
+ * not seen; those blocks are counted by malloc().
+ *
+ * mmap() calls the kernel's mmap2 where it has one, as on i386 and
+ * ARM, and mmap elsewhere, as on x86-64 and AArch64.  On 32-bit
+ * targets built with _FILE_OFFSET_BITS=64, programs call the C
+ * library's mmap64() instead, so their mappings are not counted.
+ *
+ * The definitions call glibc's own entry points, __libc_malloc(),
+ * __libc_memalign(), __libc_valloc(), __libc_pvalloc() and the
+ * others, so programs using this header must be built against glibc.
+ */
+#if !defined(MODULE_INIT_MEMORY_H_)
+#define MODULE_INIT_MEMORY_H_
+
+#include <errno.h>
+#include <malloc.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "module_init.h"
+
+#if !defined(__GLIBC__)
+#error "module_init_memory.h requires glibc"
+#endif
+
+/* The C library's allocator, which is not interposed. */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void *__libc_valloc(size_t size);
+extern void *__libc_pvalloc(size_t size);
+extern void  __libc_free(void *ptr);
+
+
+/* module_memory_allocated
+ *
+ *   Charges the block 'ptr', unless it is NULL, as one allocation.
+ *   Returns 'ptr'.
+ */
+static inline void *
+module_memory_allocated(void *ptr)
+{
+    if (ptr != NULL && module_init_memory != NULL) {
+        module_memory_charge((int64_t)malloc_usable_size(ptr), 1);
+    }
+    return ptr;
+}
+
+
+static inline void
+module_memory_released(void *ptr)
+{
+    if (ptr != NULL && module_init_memory != NULL) {
+        module_memory_charge(-(int64_t)malloc_usable_size(ptr), 0);
+    }
+}
+
+
+WEAK_ void *
+malloc(size_t size)
+{
+    return module_memory_allocated(__libc_malloc(size));
+}
+
+
+WEAK_ void *
+calloc(size_t n, size_t size)
+{
+    return module_memory_allocated(__libc_calloc(n, size));
+}
+
+
+WEAK_ void *
+realloc(void *ptr, size_t size)
+{
+    int64_t old = 0;
+    void   *result;
+
+    if (ptr != NULL && module_init_memory != NULL) {
+        old = (int64_t)malloc_usable_size(ptr);
+    }
+
+    result = __libc_realloc(ptr, size);
+    if (result != NULL || size == 0) {
+        /* 'ptr' was released.  A failed realloc() leaves it alone. */
+        module_memory_charge(-old, 0);
+    }
+    return module_memory_allocated(result);
+}
+
+
+WEAK_ void
+free(void *ptr)
+{
+    module_memory_released(ptr);
+    __libc_free(ptr);
+}
+
+
+WEAK_ void *
+memalign(size_t alignment, size_t size)
+{
+    return module_memory_allocated(__libc_memalign(alignment, size));
+}
+
+
+WEAK_ void *
+aligned_alloc(size_t alignment, size_t size)
+{
+    /* Unlike posix_memalign(), any power of two is valid, even one
+     * smaller than a pointer.
+     */
+    if ((alignment & (alignment - 1)) != 0 || alignment == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return module_memory_allocated(__libc_memalign(alignment, size));
+}
+
+
+WEAK_ int
+posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    void *result;
+
+    if (alignment % sizeof(void *) != 0 ||
+        (alignment & (alignment - 1)) != 0 || alignment == 0) {
+        return EINVAL;
+    }
+
+    result = __libc_memalign(alignment, size);
+    if (result == NULL) {
+        return ENOMEM;
+    }
+    *ptr = module_memory_allocated(result);
+    return 0;
+}
+
+
+WEAK_ void *
+valloc(size_t size)
+{
+    return module_memory_allocated(__libc_valloc(size));
+}
+
+
+WEAK_ void *
+pvalloc(size_t size)
+{
+    return module_memory_allocated(__libc_pvalloc(size));
+}
+
+
+/* mmap, munmap
+ *
+ *   Call the kernel directly; the C library's own functions cannot be
+ *   named once these are defined.  Every mapping is counted, whether
+ *   it is anonymous or of a file.
+ *
+ *   Where the kernel has mmap2, its mmap takes its arguments in a
+ *   structure, or does not exist, and mmap2 takes the offset in units
+ *   of 4096 bytes.
+ */
+#if !defined(SYS_mmap2) && !defined(SYS_mmap)
+#error Unrecognized target; no mmap system call.
+#endif
+
+WEAK_ void *
+mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset)
+{
+#if defined(SYS_mmap2)
+    long result;
+
+    if ((offset & 4095) != 0) {
+        errno = EINVAL;
+        return MAP_FAILED;
+    }
+    result = syscall(SYS_mmap2, addr, length, prot, flags, fd,
+                     (long)(offset / 4096));
+#else
+    long result = syscall(SYS_mmap, addr, length, prot, flags, fd, offset);
+#endif
+
+    if (result == -1) {
+        return MAP_FAILED;
+    }
+    module_memory_charge((int64_t)length, 1);
+    return (void *)result;
+}
+
+
+WEAK_ int
+munmap(void *addr, size_t length)
+{
+    int result = (int)syscall(SYS_munmap, addr, length);
+
+    if (result == 0) {
+        module_memory_charge(-(int64_t)length, 0);
+    }
+    return result;
+}
+
+#endif
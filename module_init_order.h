@@ -0,0 +1,128 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * This header produces the precomputed initialization order that is
+ * used by module_init.h to skip sorting modules when the program
+ * starts.
+ *
+ * The order is produced by a generator program that is linked from
+ * the same modules as the program being built, and which calls
+ * module_init_order_write().  The C source that is written is
+ * compiled and linked into the program.  The table refers to each
+ * module by the symbol declared with DECLARE_MODULE, so it is
+ * independent of the order in which the linker places the modules.
+ *
+ *   generator: generator.o <modules>
+ *   order.c:   generator
+ *                  ./generator > order.c
+ *   program:   main.o <modules> order.o
+ *
+ * See examples/initialization/Makefile.
+ */
+#if !defined(MODULE_INIT_ORDER_H_)
+#define MODULE_INIT_ORDER_H_
+
+#include <stdio.h>
+#include "module_init.h"
+
+/* module_init_order_write
+ *
+ *   Sorts all modules in the program, and writes C source for a
+ *   'module_init_order' table holding the result to 'fp'.
+ *
+ *   The result is IR_SUCCESS if the table was written.  Otherwise, it
+ *   indicates why the modules could not be sorted, and nothing is
+ *   written.
+ */
+static inline initialization_result_t
+module_init_order_write(FILE *fp)
+{
+    module_init_handle_t    handle;
+    initialization_result_t result;
+    unsigned                i;
+
+    /* The runtime sort is always used; a precomputed order linked
+     * into the generator would be stale.
+     */
+    module_handle_initialize(&handle, LINKERSET_SIZE(module_init_info,
+                                                     unsigned));
+    if (handle.table == NULL) {
+        return IR_MEMORY;
+    }
+
+    module_init_lock_acquire();
+    topological_sort_modules(&handle);
+    module_handle_unmark(&handle, 0, handle.table_index);
+    module_init_lock_release();
+    result = handle.init_state;
+    if (result != IR_SUCCESS) {
+        module_handle_finalize(&handle);
+        return result;
+    }
+
+    fprintf(fp, "/* Precomputed module initialization order.\n"
+                " *\n"
+                " * Generated by module_init_order_write(); do not edit.\n"
+                " */\n"
+                "#include \"module_init.h\"\n\n");
+
+    for (i = 0; i < handle.table_size; ++i) {
+        fprintf(fp, "extern module_init_info_t MODULE_INIT(%s);\n",
+                handle.table[i]->module_name);
+    }
+
+    fprintf(fp, "\nstatic module_init_info_t *const order_table_[%u]\n"
+                "    MODULE_INIT_ORDER_SECTION = {\n",
+            handle.table_size);
+    for (i = 0; i < handle.table_size; ++i) {
+        fprintf(fp, "    &MODULE_INIT(%s),\n", handle.table[i]->module_name);
+    }
+    fprintf(fp, "};\n");
+
+    fprintf(fp, "\nstatic const unsigned order_imports_[%u] = {\n",
+            handle.table_size);
+    for (i = 0; i < handle.table_size; ++i) {
+        fprintf(fp, "    %u,\n", module_n_edges(handle.table[i]));
+    }
+    fprintf(fp, "};\n");
+
+    fprintf(fp, "\nconst module_init_order_t module_init_order\n"
+                "    MODULE_INIT_ORDER_SECTION = {\n"
+                "    .n_modules = %u,\n"
+                "    .table     = order_table_,\n"
+                "    .n_imports = order_imports_\n"
+                "};\n",
+            handle.table_size);
+
+    module_handle_finalize(&handle);
+    return IR_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,1120 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * This header extends module_init.h so that the initialization and
+ * finalization functions of modules can be executed by a pool of
+ * threads.
+ *
+ * The IMPORT() relationships of the modules are treated as a DAG; a
+ * module's initialization function is started as soon as all the
+ * modules it imports have been initialized, and its finalization
+ * function as soon as all the modules that import it have been
+ * finalized.  No other ordering guarantees are made, so the functions
+ * of modules that do not (transitively) import each other may run
+ * concurrently.
+ *
+ * Modules that are ready are started in the order of the sorted
+ * table.  If a profile of earlier runs is installed as
+ * module_init_profile, the module heading the longest chain of
+ * expected initialization time is started first instead, as it is
+ * the one that bounds the total time.
+ *
+ * A module with an asynchronous initialization function that is
+ * pending does not occupy a thread; its importers are started by the
+ * thread that completes it.
+ *
+ * It also finishes, on a background thread, the phases that
+ * module_initialization_until() left pending.
+ *
+ * Programs using this header must be compiled and linked with
+ * '-pthread'.
+ */
+#if !defined(MODULE_INIT_PARALLEL_H_)
+#define MODULE_INIT_PARALLEL_H_
+
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "module_init.h"
+
+/* module_parallel_t
+ *
+ *  Internal type.  Holds the state shared by all threads that are
+ *  initializing, or finalizing, modules.  All fields, and the
+ *  'pending' counts, are protected by 'lock'.
+ *
+ *  Per-module arrays are indexed by the module's ordinal.
+ *
+ *  delegate:
+ *
+ *    Installed as module_init_worker on the worker threads; see
+ *    module_parallel_ensure().
+ *
+ *  n_modules:
+ *
+ *    The number of modules to initialize or finalize.  They are the
+ *    first 'n_modules' of the sorted table; lazy modules that are not
+ *    needed have been removed.
+ *
+ *  finalizing:
+ *
+ *    Non-zero if the modules are being finalized.  The edges of the
+ *    DAG are then followed from importer to import.
+ *
+ *  pending:
+ *
+ *    When initializing, the number of imports of a module that have
+ *    not yet been initialized; when finalizing, the number of its
+ *    importers that have not yet been finalized.  When it reaches
+ *    zero, the module is put on the 'ready' queue.  When a module's
+ *    function has completed, it is set to UINT_MAX; when
+ *    initializing, only if it succeeded.
+ *
+ *  edge_index, importers:
+ *
+ *    The reverse of the IMPORT() relation, stored in compressed
+ *    rows.  The importers of the module with ordinal 'i' are
+ *
+ *      importers[edge_index[i] .. edge_index[i + 1])
+ *
+ *    They are not needed, and not built, when finalizing.
+ *
+ *  ready, ready_head, ready_tail:
+ *
+ *    A FIFO of the ordinals of modules whose function can be run.
+ *    Every module is put on the queue exactly once, so it never
+ *    needs to wrap.  With 'rank', it is a binary max-heap of
+ *    [0, ready_tail) instead, and 'ready_head' stays zero.
+ *
+ *  rank:
+ *
+ *    When initializing with module_init_profile, the expected time of
+ *    the longest chain of initialization functions that starts with
+ *    each module: its own cost, plus the largest rank of its
+ *    importers.  Otherwise NULL.
+ *
+ *  order, n_done:
+ *
+ *    The modules whose function completed, in the order they
+ *    completed; when initializing, only those that succeeded, and
+ *    including those initialized on demand.  This is a valid
+ *    topological order.
+ *
+ *  n_running:
+ *
+ *    The number of functions that are executing, including
+ *    asynchronous initialization functions that are pending.
+ *
+ *  failed:
+ *
+ *    The first module whose function failed, or NULL.  Once set, no
+ *    further initialization functions are started.  When finalizing,
+ *    the modules imported by the one that failed are never ready, but
+ *    other modules continue to be finalized.
+ *
+ *  n_threads:
+ *
+ *    The number of worker threads that have started; it is used to
+ *    number them.  The calling thread is number zero.
+ *
+ *  timing:
+ *
+ *    When MO_TIMING is used, the times of each module, indexed by its
+ *    ordinal in the sorted table.  They are moved to the handle's
+ *    'timing' table when the modules are reordered.  When finalizing,
+ *    the initialization times are copied here first.
+ *
+ *  completions:
+ *
+ *    When initializing, the completion of each module's asynchronous
+ *    initialization function, indexed by its ordinal.
+ *
+ *  demand_lock, demand_depth, n_demand:
+ *
+ *    A recursive lock taken by module_parallel_ensure(), the depth of
+ *    its calls, and the number of modules it added to 'order', or
+ *    made 'failed'.  They are not protected by 'lock'.
+ */
+typedef struct module_parallel_t {
+    module_init_delegate_t delegate;
+    module_init_handle_t  *ih;
+    unsigned               n_modules;
+    int                    finalizing;
+    pthread_mutex_t        lock;
+    pthread_cond_t         cond;
+    unsigned              *pending;
+    unsigned              *edge_index;
+    unsigned              *importers;
+    unsigned              *ready;
+    unsigned               ready_head;
+    unsigned               ready_tail;
+    uint64_t              *rank;
+    module_init_info_t   **order;
+    unsigned               n_done;
+    unsigned               n_running;
+    module_init_info_t    *failed;
+    unsigned               n_threads;
+    module_timing_t       *timing;
+    module_completion_t   *completions;
+    pthread_mutex_t        demand_lock;
+    unsigned               demand_depth;
+    unsigned               n_demand;
+} module_parallel_t;
+
+
+static inline void
+module_parallel_destroy(module_parallel_t *mp)
+{
+    free(mp->pending);
+    free(mp->edge_index);
+    free(mp->importers);
+    free(mp->ready);
+    free(mp->rank);
+    free(mp->order);
+    free(mp->timing);
+    free(mp->completions);
+    pthread_cond_destroy(&mp->cond);
+    pthread_mutex_destroy(&mp->lock);
+    pthread_mutex_destroy(&mp->demand_lock);
+}
+
+
+/* module_parallel_ensure
+ *
+ *   The 'ensure' function of 'mp->delegate', which initializes 'mip'
+ *   and its imports on a worker thread, for
+ *   MODULE_ENSURE_INITIALIZED().  The workers take turns, with
+ *   'demand_lock', to run module_initialize_closure() on the handle,
+ *   which appends the modules it initializes to [table_index,
+ *   table_size) of 'ih->table', beyond the modules of 'mp'.  The
+ *   other workers meanwhile go on with those.
+ *
+ *   The modules it initialized are then added to 'order': after
+ *   their imports, which were initialized, and before the module
+ *   that asked for them, which is still running.  If one failed, it
+ *   becomes 'failed'.
+ *
+ *   As with module_initialization(), a module of 'mp' that is not yet
+ *   initialized cannot be initialized on demand; the result is then
+ *   IR_CYCLE.  When finalizing, it is IR_FAILED.
+ */
+static inline initialization_result_t
+module_parallel_ensure(module_init_delegate_t *delegate,
+                       module_init_info_t     *mip)
+{
+    module_parallel_t      *mp = (module_parallel_t *)delegate;
+    module_init_handle_t   *ih = mp->ih;
+    initialization_result_t before;
+    initialization_result_t result;
+    unsigned                first;
+    unsigned                i;
+
+    if (mp->finalizing) {
+        return IR_FAILED;
+    }
+
+    pthread_mutex_lock(&mp->demand_lock);
+    before = ih->init_state;
+    first  = ih->table_index;
+    ++mp->demand_depth;
+    result = module_initialize_closure(ih, mip);
+    --mp->demand_depth;
+
+    /* Nested calls are recorded by the outermost. */
+    if (mp->demand_depth == 0) {
+        pthread_mutex_lock(&mp->lock);
+        for (i = first; i < ih->table_index; ++i) {
+            if (mp->timing != NULL) {
+                mp->timing[i] = ih->timing[i];
+            }
+            mp->order[mp->n_done] = ih->table[i];
+            ++mp->n_done;
+            ++mp->n_demand;
+        }
+        if (before == IR_SUCCESS && result == IR_FAILED &&
+            mp->failed == NULL) {
+            mp->failed = ih->table[ih->table_index];
+            ++mp->n_demand;
+        }
+        pthread_mutex_unlock(&mp->lock);
+    }
+    pthread_mutex_unlock(&mp->demand_lock);
+    return result;
+}
+
+
+/* module_parallel_push, module_parallel_pop
+ *
+ *   Put the module with ordinal 'i' on the ready queue, and take the
+ *   next module from it.  'lock' must be held.
+ */
+static inline void
+module_parallel_push(module_parallel_t *mp, unsigned i)
+{
+    unsigned k = mp->ready_tail;
+
+    ++mp->ready_tail;
+    if (mp->rank != NULL) {
+        while (k > 0 && mp->rank[mp->ready[(k - 1) / 2]] < mp->rank[i]) {
+            mp->ready[k] = mp->ready[(k - 1) / 2];
+            k            = (k - 1) / 2;
+        }
+    }
+    mp->ready[k] = i;
+}
+
+
+static inline unsigned
+module_parallel_pop(module_parallel_t *mp)
+{
+    unsigned top;
+    unsigned last;
+    unsigned k = 0;
+
+    if (mp->rank == NULL) {
+        top = mp->ready[mp->ready_head];
+        ++mp->ready_head;
+        return top;
+    }
+
+    top  = mp->ready[0];
+    --mp->ready_tail;
+    last = mp->ready[mp->ready_tail];
+    for (;;) {
+        unsigned c = 2 * k + 1;
+
+        if (c >= mp->ready_tail) {
+            break;
+        }
+        if (c + 1 < mp->ready_tail &&
+            mp->rank[mp->ready[c + 1]] > mp->rank[mp->ready[c]]) {
+            ++c;
+        }
+        if (mp->rank[mp->ready[c]] <= mp->rank[last]) {
+            break;
+        }
+        mp->ready[k] = mp->ready[c];
+        k            = c;
+    }
+    mp->ready[k] = last;
+    return top;
+}
+
+
+/* module_parallel_rank
+ *
+ *   Computes 'rank' from the costs given by 'profile'.  Importers
+ *   follow their imports in the sorted table, so the ranks can be
+ *   found in one pass backwards.  If memory cannot be allocated,
+ *   'rank' is left NULL.
+ */
+static inline void
+module_parallel_rank(module_parallel_t *mp, module_profile_t *profile)
+{
+    unsigned i = mp->n_modules;
+
+    mp->rank = calloc(mp->n_modules, sizeof(uint64_t));
+    if (mp->rank == NULL) {
+        return;
+    }
+
+    while (i != 0) {
+        uint64_t longest = 0;
+        unsigned e;
+
+        --i;
+        for (e = mp->edge_index[i]; e < mp->edge_index[i + 1]; ++e) {
+            assert(mp->importers[e] > i);
+            if (mp->rank[mp->importers[e]] > longest) {
+                longest = mp->rank[mp->importers[e]];
+            }
+        }
+        mp->rank[i] = profile->cost(profile, mp->ih->table[i]) + longest;
+    }
+}
+
+
+/* module_parallel_create
+ *
+ *   Builds the scheduling state for the modules in [0, table_index)
+ *   of 'ih->table', which must have been successfully sorted; or, if
+ *   'finalizing' is non-zero, initialized.
+ *
+ *   Returns 0 if memory could not be allocated.
+ */
+static inline int
+module_parallel_create(module_parallel_t *mp,
+                       module_init_handle_t *ih,
+                       int                   finalizing)
+{
+    const unsigned      n       = ih->table_index;
+    unsigned            n_edges = 0;
+    unsigned            i;
+    pthread_mutexattr_t attr;
+
+    mp->delegate.ensure = module_parallel_ensure;
+    mp->ih              = ih;
+    mp->n_modules       = n;
+    mp->finalizing      = finalizing;
+    mp->ready_head      = 0;
+    mp->ready_tail      = 0;
+    mp->rank            = NULL;
+    mp->n_done          = 0;
+    mp->n_running       = 0;
+    mp->failed          = NULL;
+    mp->n_threads       = 0;
+    mp->demand_depth    = 0;
+    mp->n_demand        = 0;
+    pthread_mutex_init(&mp->lock, NULL);
+    pthread_cond_init(&mp->cond, NULL);
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mp->demand_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    mp->pending    = calloc(n, sizeof(unsigned));
+    mp->edge_index = calloc(n + 1, sizeof(unsigned));
+    mp->ready      = calloc(n, sizeof(unsigned));
+    mp->order      = calloc(ih->table_size, sizeof(module_init_info_t *));
+    mp->importers   = NULL;
+    mp->timing      = NULL;
+    mp->completions = NULL;
+    if (ih->timing != NULL) {
+        /* Modules initialized on demand follow the first 'n'. */
+        mp->timing = calloc(ih->table_size, sizeof(module_timing_t));
+    }
+    if (!finalizing) {
+        mp->completions = calloc(n, sizeof(module_completion_t));
+    }
+
+    if (mp->pending == NULL || mp->edge_index == NULL ||
+        mp->ready == NULL || mp->order == NULL ||
+        (ih->timing != NULL && mp->timing == NULL) ||
+        (!finalizing && mp->completions == NULL) ||
+        (!finalizing && n < ih->table_size && !module_handle_writable(ih))) {
+        module_parallel_destroy(mp);
+        return 0;
+    }
+
+    if (finalizing) {
+        /* A module can be finalized when all its importers have been
+         * finalized.  Modules that nothing imports are queued first,
+         * in the reverse of the initialization order.
+         */
+        for (i = 0; i < n; ++i) {
+            unsigned e;
+
+            for (e = 0; e < module_n_edges(ih->table[i]); ++e) {
+                unsigned imp = module_edge_index(ih, n, ih->table[i], e);
+
+                if (imp != UINT_MAX) {
+                    ++mp->pending[imp];
+                }
+            }
+        }
+
+        i = n;
+        while (i != 0) {
+            --i;
+            if (mp->pending[i] == 0) {
+                module_parallel_push(mp, i);
+            }
+        }
+
+        if (mp->timing != NULL) {
+            memcpy(mp->timing, ih->timing, n * sizeof(module_timing_t));
+        }
+        return 1;
+    }
+
+    /* The modules of a precomputed order are not marked.  Marked, they
+     * are left to the workers by module_parallel_ensure().
+     */
+    for (i = 0; i < n; ++i) {
+        if (module_state(ih->table[i]) != IS_INITIALIZED &&
+            module_marks(ih->table[i]) == 0) {
+            module_mark(ih->table[i], MODULE_MARK_SORTED);
+        }
+    }
+
+    /* Count the imports of every module, and the importers of every
+     * module.  edge_index[i + 1] temporarily holds the number of
+     * importers of module 'i'.  Ordering-only edges count as imports
+     * when both modules are being initialized.
+     */
+    for (i = 0; i < n; ++i) {
+        unsigned e;
+
+        for (e = 0; e < module_n_edges(ih->table[i]); ++e) {
+            unsigned imp = module_edge_index(ih, n, ih->table[i], e);
+
+            if (imp != UINT_MAX) {
+                ++mp->pending[i];
+                ++mp->edge_index[imp + 1];
+                ++n_edges;
+            }
+        }
+    }
+
+    for (i = 0; i < n; ++i) {
+        mp->edge_index[i + 1] += mp->edge_index[i];
+    }
+
+    if (n_edges != 0) {
+        unsigned *fill = calloc(n, sizeof(unsigned));
+
+        mp->importers = calloc(n_edges, sizeof(unsigned));
+        if (fill == NULL || mp->importers == NULL) {
+            free(fill);
+            module_parallel_destroy(mp);
+            return 0;
+        }
+
+        for (i = 0; i < n; ++i) {
+            unsigned e;
+
+            for (e = 0; e < module_n_edges(ih->table[i]); ++e) {
+                unsigned imp = module_edge_index(ih, n, ih->table[i], e);
+
+                if (imp != UINT_MAX) {
+                    mp->importers[mp->edge_index[imp] + fill[imp]] = i;
+                    ++fill[imp];
+                }
+            }
+        }
+        free(fill);
+    }
+
+    /* Without a profile, or the memory for the ranks, the modules are
+     * started in the order of the sorted table.
+     */
+    if (module_init_profile != NULL) {
+        module_parallel_rank(mp, module_init_profile);
+    }
+
+    /* Modules without imports can be initialized immediately. */
+    for (i = 0; i < n; ++i) {
+        if (mp->pending[i] == 0) {
+            module_parallel_push(mp, i);
+        }
+    }
+    return 1;
+}
+
+
+/* module_parallel_done
+ *
+ *   Records that the function of 'mip' has returned 'result', and
+ *   makes the modules that were waiting only for it ready.  'lock'
+ *   must be held.
+ */
+static inline void
+module_parallel_done(module_parallel_t  *mp,
+                     module_init_info_t *mip,
+                     int                 result)
+{
+    int wake = 0;
+
+    --mp->n_running;
+
+    if (mp->finalizing) {
+        unsigned e;
+
+        mp->pending[*mip->ordinal] = UINT_MAX;
+        mp->order[mp->n_done]      = mip;
+        ++mp->n_done;
+
+        if (result != 0) {
+            /* Finalizing a module failed.  The modules it imports
+             * are not finalized, because it may still be relying
+             * on them; see module_finalization().
+             */
+            if (mp->failed == NULL) {
+                mp->failed = mip;
+            }
+        } else {
+            module_arena_release(module_impl(mip));
+            module_set_state(mip, IS_UNINITIALIZED);
+            for (e = 0; e < module_n_edges(mip); ++e) {
+                unsigned imp = module_edge_index(mp->ih, mp->n_modules,
+                                                 mip, e);
+
+                if (imp == UINT_MAX) {
+                    continue;
+                }
+                --mp->pending[imp];
+                if (mp->pending[imp] == 0) {
+                    module_parallel_push(mp, imp);
+                    wake = 1;
+                }
+            }
+        }
+    } else if (result != 0) {
+        module_arena_release(module_impl(mip));
+        module_set_state(mip, IS_UNINITIALIZED);
+        module_cancel(mip);
+        if (mp->failed == NULL) {
+            mp->failed = mip;
+        }
+        wake = 1;
+    } else {
+        unsigned e;
+
+        module_set_state(mip, IS_INITIALIZED);
+        mp->pending[*mip->ordinal] = UINT_MAX;
+        mp->order[mp->n_done]      = mip;
+        ++mp->n_done;
+
+        for (e = mp->edge_index[*mip->ordinal];
+             e < mp->edge_index[*mip->ordinal + 1];
+             ++e) {
+            unsigned importer = mp->importers[e];
+
+            --mp->pending[importer];
+            if (mp->pending[importer] == 0) {
+                module_parallel_push(mp, importer);
+                wake = 1;
+            }
+        }
+    }
+
+    if (wake || mp->n_running == 0) {
+        pthread_cond_broadcast(&mp->cond);
+    }
+}
+
+
+/* module_parallel_async_time
+ *
+ *   Records the wall time of an asynchronous initialization function,
+ *   from when it was called until now.  Its CPU time is recorded by
+ *   the thread that called it, and is only the time until it
+ *   returned.
+ */
+static inline void
+module_parallel_async_time(module_parallel_t   *mp,
+                           module_completion_t *completion)
+{
+    module_time_t *time = completion->time;
+
+    if (time != NULL) {
+        time->wall_ns  = (module_clock_ns(CLOCK_MONOTONIC) -
+                          completion->start_ns);
+        time->start_ns = completion->start_ns - mp->ih->timing_epoch_ns;
+        time->self_ns  = time->wall_ns;
+    }
+}
+
+
+/* module_parallel_complete
+ *
+ *   The 'complete' function of the completions of asynchronous
+ *   initialization functions that are pending.
+ */
+static inline void
+module_parallel_complete(module_completion_t *completion, int result)
+{
+    module_parallel_t *mp = (module_parallel_t *)completion->engine;
+
+    module_parallel_async_time(mp, completion);
+    pthread_mutex_lock(&mp->lock);
+    module_parallel_done(mp, completion->module, result);
+    pthread_mutex_unlock(&mp->lock);
+}
+
+
+/* module_parallel_start_async
+ *
+ *   Calls the asynchronous initialization function of 'mip'.  Returns
+ *   MODULE_INIT_PENDING, or the result of the function if it returned
+ *   one immediately.  With MO_MEMORY, only the allocations made before
+ *   it returns are charged to the module, and module_init_watch only
+ *   sees the call until it returns.
+ */
+static inline int
+module_parallel_start_async(module_parallel_t  *mp,
+                            module_init_info_t *mip,
+                            unsigned            thread)
+{
+    module_completion_t *completion = &mp->completions[*mip->ordinal];
+    module_memory_t     *saved      = module_init_memory;
+    module_watch_t      *watch      = module_init_watch;
+    uint64_t             cpu        = 0;
+    int                  result;
+
+    completion->module   = mip;
+    completion->complete = module_parallel_complete;
+    completion->engine   = mp;
+    completion->time     = NULL;
+    if (mp->timing != NULL) {
+        mp->timing[*mip->ordinal].thread = thread;
+        completion->time     = &mp->timing[*mip->ordinal].init;
+        completion->start_ns = module_clock_ns(CLOCK_MONOTONIC);
+        cpu                  = module_clock_ns(CLOCK_THREAD_CPUTIME_ID);
+        if (mp->ih->options & MO_MEMORY) {
+            module_init_memory = &mp->timing[*mip->ordinal].memory;
+        }
+    }
+
+    if (watch != NULL) {
+        watch->begin(watch, mip);
+    }
+    result             = module_impl(mip)->async_init_fn(completion);
+    module_init_memory = saved;
+    if (watch != NULL) {
+        watch->end(watch, mip);
+    }
+
+    if (mp->timing != NULL) {
+        mp->timing[*mip->ordinal].init.cpu_ns =
+            module_clock_ns(CLOCK_THREAD_CPUTIME_ID) - cpu;
+    }
+    if (result != MODULE_INIT_PENDING) {
+        module_parallel_async_time(mp, completion);
+    }
+    return result;
+}
+
+
+/* module_parallel_run
+ *
+ *   The body of each worker thread, including the calling thread.
+ *   Modules are taken from the ready queue and initialized until all
+ *   modules have been initialized, or until one fails.  When
+ *   finalizing, modules are finalized until no more are ready and
+ *   none are running.  In either case, it returns only when no
+ *   asynchronous initialization function is pending.
+ *
+ *   'thread' is the number of the thread, recorded with the times of
+ *   the modules it initializes.  While it runs, the thread is one of
+ *   the engine's workers; see module_ensure_initialized().
+ */
+static inline void
+module_parallel_run(module_parallel_t *mp, unsigned thread)
+{
+    module_init_handle_t *ih       = mp->ih;
+    uint64_t              child_ns = 0;
+
+    module_init_worker = &mp->delegate;
+    pthread_mutex_lock(&mp->lock);
+    for (;;) {
+        module_init_info_t *mip;
+        int                 init_result = 0;
+
+        while ((mp->failed == NULL || mp->finalizing) &&
+               mp->ready_head == mp->ready_tail &&
+               mp->n_running != 0) {
+            pthread_cond_wait(&mp->cond, &mp->lock);
+        }
+
+        if ((mp->failed != NULL && !mp->finalizing) ||
+            mp->ready_head == mp->ready_tail) {
+            /* A module failed, or nothing is running and nothing can
+             * be started, which means all modules are done.
+             */
+            break;
+        }
+
+        mip = ih->table[module_parallel_pop(mp)];
+        ++mp->n_running;
+        pthread_mutex_unlock(&mp->lock);
+
+        if (mp->finalizing) {
+            if (module_impl(mip)->fina_fn != NULL) {
+                module_timing_t *timing = NULL;
+
+                if (mp->timing != NULL) {
+                    timing              = &mp->timing[*mip->ordinal];
+                    timing->fina_thread = thread;
+                }
+                init_result = module_call(ih, module_impl(mip)->fina_fn,
+                                          timing != NULL ? &timing->fina : NULL,
+                                          &child_ns);
+            }
+        } else {
+            module_set_state(mip, IS_INITIALIZING);
+            if (module_impl(mip)->async_init_fn != NULL) {
+                init_result = module_parallel_start_async(mp, mip, thread);
+                if (init_result == MODULE_INIT_PENDING) {
+                    /* module_parallel_complete() finishes it. */
+                    pthread_mutex_lock(&mp->lock);
+                    continue;
+                }
+            } else {
+                module_timing_t *timing = NULL;
+
+                if (mp->timing != NULL) {
+                    timing         = &mp->timing[*mip->ordinal];
+                    timing->thread = thread;
+                }
+                init_result = module_init_call(ih, mip, timing, &child_ns);
+            }
+        }
+
+        pthread_mutex_lock(&mp->lock);
+        module_parallel_done(mp, mip, init_result);
+    }
+
+    /* The completions of pending modules refer to 'mp'. */
+    while (mp->n_running != 0) {
+        pthread_cond_wait(&mp->cond, &mp->lock);
+    }
+    pthread_mutex_unlock(&mp->lock);
+    module_init_worker = NULL;
+}
+
+
+static inline void *
+module_parallel_worker(void *arg)
+{
+    module_parallel_t *mp = (module_parallel_t *)arg;
+    unsigned           thread;
+
+    pthread_mutex_lock(&mp->lock);
+    ++mp->n_threads;
+    thread = mp->n_threads;
+    pthread_mutex_unlock(&mp->lock);
+
+    module_parallel_run(mp, thread);
+    return NULL;
+}
+
+
+/* module_parallel_reorder
+ *
+ *   Rewrites 'ih->table' so that it has the same meaning it has after
+ *   sequential initialization:
+ *
+ *     [0, table_index)  : the initialized modules, in an order that
+ *                         is suitable for sequential finalization
+ *                         (in reverse).
+ *
+ *     table_index       : the module that failed, if 'init_state'
+ *                         is IR_FAILED.
+ *
+ *     (table_index, n_modules) : modules that were not initialized.
+ *                                They are unmarked, and canceled if
+ *                                a module failed.
+ *
+ *     [n_modules, table_size)   : undefined.
+ *
+ *   If more than one module failed concurrently, only the first is
+ *   reported; the others are treated as not initialized.
+ */
+static inline void
+module_parallel_reorder(module_parallel_t *mp)
+{
+    module_init_handle_t *ih = mp->ih;
+    unsigned              n  = mp->n_done;
+    unsigned              i;
+
+    if (mp->failed != NULL) {
+        mp->order[n] = mp->failed;
+        ++n;
+    }
+
+    for (i = 0; i < mp->n_modules; ++i) {
+        module_init_info_t *mip = ih->table[i];
+
+        if (mp->pending[i] != UINT_MAX && mip != mp->failed) {
+            module_mark(mip, 0);
+            if (mp->failed != NULL) {
+                module_cancel(mip);
+            }
+            mp->order[n] = mip;
+            ++n;
+        }
+    }
+    assert(n == mp->n_modules + mp->n_demand);
+
+    /* The completion order replaces 'ih->table', which may be a
+     * read-only precomputed order.
+     */
+    if (ih->table_allocated) {
+        free(ih->table);
+    }
+    ih->table           = mp->order;
+    ih->table_allocated = 1;
+    mp->order           = NULL;
+
+    for (i = 0; i < mp->n_modules; ++i) {
+        if (mp->timing != NULL) {
+            ih->timing[i] = mp->timing[*ih->table[i]->ordinal];
+        }
+        *ih->table[i]->ordinal = i;
+    }
+
+    ih->table_index = mp->n_done;
+    if (mp->failed != NULL) {
+        ih->init_state = IR_FAILED;
+    }
+}
+
+
+/* module_parallel_reorder_finalized
+ *
+ *   Rewrites 'ih->table' so that it has the same meaning it has after
+ *   sequential finalization:
+ *
+ *     [0, table_index)  : the modules that were not finalized.
+ *
+ *     [table_index, n_modules) : the modules whose finalization
+ *                                function was run.
+ *
+ *   Both keep their initialization order.  The modules that were not
+ *   finalized are all imported by those that were not, or by one that
+ *   failed, so the whole table remains a topological order.
+ *
+ *   'init_state' is set to IR_FAILED if a finalization function
+ *   failed.
+ */
+static inline void
+module_parallel_reorder_finalized(module_parallel_t *mp)
+{
+    module_init_handle_t *ih = mp->ih;
+    const unsigned        n  = mp->n_modules - mp->n_done;
+    unsigned              k  = 0;
+    unsigned              f  = n;
+    unsigned              i;
+
+    for (i = 0; i < mp->n_modules; ++i) {
+        if (mp->pending[i] != UINT_MAX) {
+            mp->order[k] = ih->table[i];
+            ++k;
+        } else {
+            mp->order[f] = ih->table[i];
+            ++f;
+        }
+    }
+    assert(k == n && f == mp->n_modules);
+    memcpy(&mp->order[mp->n_modules], &ih->table[mp->n_modules],
+           (ih->table_size - mp->n_modules) * sizeof(module_init_info_t *));
+
+    /* As when initializing, 'ih->table' may be read-only. */
+    if (ih->table_allocated) {
+        free(ih->table);
+    }
+    ih->table           = mp->order;
+    ih->table_allocated = 1;
+    mp->order           = NULL;
+
+    for (i = 0; i < mp->n_modules; ++i) {
+        if (mp->timing != NULL) {
+            ih->timing[i] = mp->timing[*ih->table[i]->ordinal];
+        }
+        *ih->table[i]->ordinal = i;
+    }
+
+    ih->table_index = n;
+    if (mp->failed != NULL) {
+        ih->init_state = IR_FAILED;
+    }
+}
+
+
+/* module_parallel_execute
+ *
+ *   Runs 'mp' on 'n_workers' threads, one of which is the calling
+ *   thread; zero means one thread per online processor.  Returns
+ *   when all worker threads have exited.
+ */
+static inline void
+module_parallel_execute(module_parallel_t *mp, unsigned n_workers)
+{
+    pthread_t *workers   = NULL;
+    unsigned   n_started = 0;
+    unsigned   i;
+
+    if (n_workers == 0) {
+        long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        n_workers = n_cpus > 0 ? (unsigned)n_cpus : 1;
+    }
+    if (n_workers > mp->n_modules) {
+        n_workers = mp->n_modules;
+    }
+
+    if (n_workers > 1) {
+        workers = calloc(n_workers - 1, sizeof(pthread_t));
+    }
+    if (workers != NULL) {
+        while (n_started < n_workers - 1 &&
+               pthread_create(&workers[n_started], NULL,
+                              module_parallel_worker, mp) == 0) {
+            ++n_started;
+        }
+    }
+
+    module_parallel_run(mp, 0);
+
+    for (i = 0; i < n_started; ++i) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+}
+
+
+/* module_initialization_parallel
+ *
+ *   This function has the same results as module_initialization(),
+ *   but the initialization functions are executed by 'n_workers'
+ *   threads, one of which is the calling thread.  If 'n_workers' is
+ *   zero, one thread per online processor is used.
+ *
+ *   If threads cannot be created, the remaining work is done by the
+ *   threads that were created, at worst by only the calling thread.
+ *
+ *   On return, all worker threads have exited, and 'ih' can be used
+ *   with module_finalization() exactly as if module_initialization()
+ *   had been used.
+ *
+ *   The initialization functions run by the workers may initialize
+ *   lazy modules with MODULE_ENSURE_INITIALIZED(), one worker at a
+ *   time; see module_parallel_ensure().  Other threads that call
+ *   MODULE_ENSURE_INITIALIZED() meanwhile wait until this function
+ *   returns.
+ *
+ *   As with module_initialization_with(), modules that are already
+ *   initialized are skipped.  The modules of all phases are
+ *   initialized.
+ *
+ *   'options' is a bitwise-or of module_init_option_t values.
+ */
+static inline void
+module_initialization_parallel_with(module_init_handle_t *ih,
+                                   unsigned              n_workers,
+                                   unsigned              options)
+{
+    module_parallel_t mp;
+
+    module_init_lock_acquire();
+    module_handle_sort(ih, options);
+    if (ih->init_state == IR_SUCCESS) {
+        module_handle_eager(ih);
+    }
+    if (ih->init_state == IR_SUCCESS &&
+        !module_parallel_create(&mp, ih, 0)) {
+        module_handle_unmark(ih, 0, ih->table_index);
+        ih->init_state = IR_MEMORY;
+    }
+    if (ih->init_state == IR_SUCCESS) {
+        module_parallel_execute(&mp, n_workers);
+        module_parallel_reorder(&mp);
+        module_parallel_destroy(&mp);
+        if (module_init_lazy_handle == NULL) {
+            module_init_lazy_handle = ih;
+        }
+    }
+    module_init_lock_release();
+}
+
+
+/* module_initialization_parallel
+ *
+ *   Initializes all modules in parallel with no options.  See
+ *   module_initialization_parallel_with().
+ */
+static inline void
+module_initialization_parallel(module_init_handle_t *ih, unsigned n_workers)
+{
+    module_initialization_parallel_with(ih, n_workers, 0);
+}
+
+
+/* module_initialization_background
+ *
+ *   Starts a thread, stored in '*thread', that initializes the modules
+ *   that module_initialization_until() left pending in 'ih', with
+ *   module_initialization_pending(), while the calling thread goes on
+ *   to work.  The result is that of pthread_create().
+ *
+ *   The thread must be joined, with pthread_join(), before 'ih' is
+ *   finalized; 'ih->init_state' then holds the result.
+ */
+static inline void *
+module_background_run(void *arg)
+{
+    module_initialization_pending((module_init_handle_t *)arg);
+    return NULL;
+}
+
+
+static inline int
+module_initialization_background(module_init_handle_t *ih,
+                                 pthread_t            *thread)
+{
+    return pthread_create(thread, NULL, module_background_run, ih);
+}
+
+
+/* module_finalization_parallel
+ *
+ *   This function has the same results as module_finalization(), but
+ *   the finalization functions are executed by 'n_workers' threads,
+ *   one of which is the calling thread.  If 'n_workers' is zero, one
+ *   thread per online processor is used.  It can be used however the
+ *   modules were initialized.
+ *
+ *   A module is finalized only after every module that imports it
+ *   has been finalized.  If a finalization function fails, the
+ *   modules it imports, directly or not, are not finalized, as with
+ *   module_finalization(); modules that it does not import continue
+ *   to be finalized.  'init_state' is then IR_FAILED, and the modules
+ *   that were not finalized are [0, table_index) of 'ih->table'.
+ *
+ *   If memory cannot be allocated, the modules are finalized by
+ *   module_finalization().
+ */
+static inline void
+module_finalization_parallel(module_init_handle_t *ih, unsigned n_workers)
+{
+    module_parallel_t mp;
+
+    if (ih->table == NULL) {
+        return;                 /* Finalization done. */
+    }
+
+    module_init_lock_acquire();
+    if (ih->table_index > ih->timing_count) {
+        ih->timing_count = ih->table_index;
+    }
+
+    if (module_parallel_create(&mp, ih, 1)) {
+        module_parallel_execute(&mp, n_workers);
+        module_parallel_reorder_finalized(&mp);
+        module_parallel_destroy(&mp);
+    } else {
+        module_finalization(ih);
+    }
+    module_init_lock_release();
+}
+
+
+#endif
@@ -0,0 +1,276 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * This header keeps a profile of the time taken by each module's
+ * initialization function, so that module_initialization_parallel()
+ * can start the modules on the critical path first.  This is the idea
+ * of profile-guided optimization, applied to the IMPORT() DAG.
+ *
+ * A run with MO_TIMING saves the times to a small text file, and later
+ * runs load it before initializing modules:
+ *
+ *   module_profile_file_t profile;
+ *
+ *   if (module_profile_load(&profile, "init.profile") == 0) {
+ *       module_init_profile = &profile.profile;
+ *   }
+ *   module_initialization_parallel_with(&handle, 0, MO_TIMING);
+ *   module_init_profile = NULL;
+ *   module_profile_destroy(&profile);
+ *   module_profile_save(&handle, "init.profile");
+ *
+ * If there is no profile, or it cannot be read, nothing is installed
+ * and the modules are started in the order of the sorted table, as
+ * without this header.  Modules that are not in the profile, such as
+ * new ones, are expected to take the mean time of those that are.
+ *
+ * The file has a header line, then one line per module: the time of
+ * its initialization function in nanoseconds, and its name.
+ */
+#if !defined(MODULE_INIT_PROFILE_H_)
+#define MODULE_INIT_PROFILE_H_
+
+#include <inttypes.h>
+#include <stdio.h>
+#include "module_init_timing.h"
+
+#define MODULE_PROFILE_HEADER "module_init profile 1\n"
+
+/* module_profile_entry_t
+ *
+ *  The expected time of the initialization function of the module
+ *  named 'name'.
+ */
+typedef struct module_profile_entry_t {
+    char     *name;
+    uint64_t  ns;
+} module_profile_entry_t;
+
+
+/* module_profile_file_t
+ *
+ *  profile:    The module_profile_t to install as module_init_profile.
+ *
+ *  entries:    The modules of the profile, sorted by name.
+ *
+ *  default_ns: The cost of modules that are not in the profile.
+ */
+typedef struct module_profile_file_t {
+    module_profile_t        profile;
+    unsigned                n_entries;
+    module_profile_entry_t *entries;
+    uint64_t                default_ns;
+} module_profile_file_t;
+
+
+static inline int
+module_profile_compare(const void *a, const void *b)
+{
+    return strcmp(((const module_profile_entry_t *)a)->name,
+                  ((const module_profile_entry_t *)b)->name);
+}
+
+
+static inline uint64_t
+module_profile_cost(module_profile_t *profile, module_init_info_t *mip)
+{
+    module_profile_file_t  *pf  = (module_profile_file_t *)profile;
+    module_profile_entry_t  key = { (char *)mip->module_name, 0 };
+    module_profile_entry_t *entry;
+
+    entry = bsearch(&key, pf->entries, pf->n_entries,
+                    sizeof(module_profile_entry_t), module_profile_compare);
+    return entry != NULL ? entry->ns : pf->default_ns;
+}
+
+
+/* module_profile_destroy
+ *
+ *   Frees the entries of 'pf'.  It must not be installed as
+ *   module_init_profile while modules are being initialized.
+ */
+static inline void
+module_profile_destroy(module_profile_file_t *pf)
+{
+    unsigned i;
+
+    for (i = 0; i < pf->n_entries; ++i) {
+        free(pf->entries[i].name);
+    }
+    free(pf->entries);
+    pf->n_entries = 0;
+    pf->entries   = NULL;
+}
+
+
+/* module_profile_load
+ *
+ *   Reads the profile at 'path' into 'pf'.
+ *
+ *   Returns zero on success.  Otherwise, if the file does not exist,
+ *   is not a profile, or memory could not be allocated, 'pf' is empty
+ *   and must not be installed; module_profile_destroy() may still be
+ *   called.
+ */
+static inline int
+module_profile_load(module_profile_file_t *pf, const char *path)
+{
+    char     *line     = NULL;
+    size_t    capacity = 0;
+    unsigned  max      = 0;
+    uint64_t  total    = 0;
+    int       result   = -1;
+    FILE     *fp;
+
+    memset(pf, 0, sizeof(*pf));
+    pf->profile.cost = module_profile_cost;
+
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    if (getline(&line, &capacity, fp) < 0 ||
+        strcmp(line, MODULE_PROFILE_HEADER) != 0) {
+        goto done;
+    }
+
+    while (getline(&line, &capacity, fp) > 0) {
+        char     *name;
+        char     *end;
+        uint64_t  ns = strtoull(line, &name, 10);
+
+        if (name == line || *name != ' ') {
+            goto done;
+        }
+        ++name;
+        end = strchr(name, '\n');
+        if (end != NULL) {
+            *end = '\0';
+        }
+        if (*name == '\0') {
+            goto done;
+        }
+
+        if (pf->n_entries == max) {
+            module_profile_entry_t *entries;
+
+            max     = max != 0 ? 2 * max : 64;
+            entries = realloc(pf->entries,
+                              max * sizeof(module_profile_entry_t));
+            if (entries == NULL) {
+                goto done;
+            }
+            pf->entries = entries;
+        }
+
+        pf->entries[pf->n_entries].name = strdup(name);
+        pf->entries[pf->n_entries].ns   = ns;
+        if (pf->entries[pf->n_entries].name == NULL) {
+            goto done;
+        }
+        ++pf->n_entries;
+        total += ns;
+    }
+
+    if (!ferror(fp) && pf->n_entries != 0) {
+        qsort(pf->entries, pf->n_entries, sizeof(module_profile_entry_t),
+              module_profile_compare);
+        pf->default_ns = total / pf->n_entries;
+        result         = 0;
+    }
+
+done:
+    if (result != 0) {
+        module_profile_destroy(pf);
+    }
+    free(line);
+    fclose(fp);
+    return result;
+}
+
+
+/* module_profile_save
+ *
+ *   Writes the times of the initialization functions recorded in 'ih'
+ *   by MO_TIMING to 'path'.  The file is written under another name
+ *   and renamed, so a program starting meanwhile reads either the old
+ *   profile or the new one.
+ *
+ *   Returns zero on success, and non-zero if no times were recorded
+ *   or the file could not be written.
+ */
+static inline int
+module_profile_save(const module_init_handle_t *ih, const char *path)
+{
+    const size_t  len = strlen(path);
+    char         *tmp;
+    FILE         *fp;
+    unsigned      i;
+    int           result;
+
+    if (ih->timing == NULL) {
+        return -1;
+    }
+
+    tmp = malloc(len + sizeof(".tmp"));
+    if (tmp == NULL) {
+        return -1;
+    }
+    memcpy(tmp, path, len);
+    memcpy(tmp + len, ".tmp", sizeof(".tmp"));
+
+    fp = fopen(tmp, "w");
+    if (fp == NULL) {
+        free(tmp);
+        return -1;
+    }
+
+    fputs(MODULE_PROFILE_HEADER, fp);
+    for (i = 0; i < module_timing_count(ih); ++i) {
+        fprintf(fp, "%" PRIu64 " %s\n",
+                ih->timing[i].init.self_ns, ih->table[i]->module_name);
+    }
+
+    result = ferror(fp) != 0 ? -1 : 0;
+    if (fclose(fp) != 0) {
+        result = -1;
+    }
+    if (result == 0 && rename(tmp, path) != 0) {
+        result = -1;
+    }
+    if (result != 0) {
+        remove(tmp);
+    }
+    free(tmp);
+    return result;
+}
+
+#endif
@@ -0,0 +1,341 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * This header replaces modules of a running program with those of a
+ * shared object, without restarting it.  Only the modules that import
+ * a replaced module, directly or not, are finalized and initialized
+ * again; every other module stays initialized.
+ *
+ * The shared object is compiled with MODULE_INIT_DSO defined, and
+ * declares the replacements with DECLARE_MODULE, under the names of
+ * the modules they replace.  The program must be linked with
+ * '-rdynamic', so that the shared object's IMPORT()s, and its calls
+ * into the program, refer to the program's modules:
+ *
+ *   cc -rdynamic -o server server.o <modules> -ldl
+ *   cc -DMODULE_INIT_DSO -fPIC -shared -o mod_x.so mod_x.c
+ *
+ * A replacement's imports must be imports of the module it replaces;
+ * it cannot add edges to the IMPORT() DAG.  Only its functions are
+ * used: its initialization, finalization and fork functions are
+ * called in place of the module's, which otherwise keeps its state,
+ * phase and edges.
+ *
+ * module_reload() does, with module_init_lock held:
+ *
+ *   o Finalize the initialized modules that import a replaced module,
+ *     and the replaced modules themselves, importers first.
+ *
+ *   o Install the replacements; see module_impl().
+ *
+ *   o Initialize the same modules again, imports first.
+ *
+ * Threads that use MODULE_ENSURE_INITIALIZED() on one of them
+ * meanwhile wait until it is initialized again.
+ */
+#if !defined(MODULE_INIT_RELOAD_H_)
+#define MODULE_INIT_RELOAD_H_
+
+#include <dlfcn.h>
+#include "module_init.h"
+
+/* module_reload_edges_valid
+ *
+ *   Returns non-zero if every edge of the replacement 'repl' is an
+ *   edge of the module 'live' it replaces.  An edge to a module of
+ *   the shared object is an edge to the module that one replaces.
+ */
+static inline int
+module_reload_edges_valid(module_init_info_t  *live,
+                          module_init_info_t  *repl,
+                          module_init_info_t **repls,
+                          module_init_info_t **lives,
+                          unsigned             n_repls)
+{
+    unsigned e;
+
+    for (e = 0; e < module_n_edges(repl); ++e) {
+        module_init_info_t *edge = module_edge(repl, e);
+        unsigned            k;
+        int                 found = 0;
+
+        for (k = 0; k < n_repls; ++k) {
+            if (edge == repls[k]) {
+                edge = lives[k];
+            }
+        }
+        if (edge == NULL) {
+            continue;           /* A weak edge to a missing module. */
+        }
+        for (k = 0; k < module_n_edges(live) && !found; ++k) {
+            found = module_edge(live, k) == edge;
+        }
+        if (!found) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/* module_reload_compact
+ *
+ *   Moves the modules of [0, table_index) that are not initialized,
+ *   after a replacement failed to initialize, to the end of that
+ *   range, keeping the order of both parts, and puts 'failed' first
+ *   among them.  'order' has room for 'table_index' modules.
+ */
+static inline void
+module_reload_compact(module_init_handle_t *ih,
+                      module_init_info_t   *failed,
+                      module_init_info_t  **order)
+{
+    const unsigned   n      = ih->table_index;
+    module_timing_t *timing = NULL;
+    unsigned         k      = 0;
+    unsigned         i;
+
+    for (i = 0; i < n; ++i) {
+        if (module_state(ih->table[i]) == IS_INITIALIZED) {
+            order[k] = ih->table[i];
+            ++k;
+        }
+    }
+    ih->table_index = k;
+    order[k]        = failed;
+    ++k;
+    for (i = 0; i < n; ++i) {
+        if (module_state(ih->table[i]) != IS_INITIALIZED &&
+            ih->table[i] != failed) {
+            order[k] = ih->table[i];
+            ++k;
+        }
+    }
+    assert(k == n);
+
+    if (ih->timing != NULL) {
+        timing = calloc(n, sizeof(module_timing_t));
+    }
+    for (i = 0; i < n; ++i) {
+        if (timing != NULL) {
+            timing[i] = ih->timing[*order[i]->ordinal];
+        }
+        ih->table[i]           = order[i];
+        *ih->table[i]->ordinal = i;
+    }
+    if (timing != NULL) {
+        memcpy(ih->timing, timing, n * sizeof(module_timing_t));
+        free(timing);
+    }
+    ih->init_state = IR_FAILED;
+}
+
+
+/* module_reload
+ *
+ *   Loads the shared object at 'path', and replaces the modules of the
+ *   program that it declares.  'ih' is the handle that initialized
+ *   the program.  '*dso' is set to the handle of the shared object,
+ *   which must stay loaded while its replacements are installed; when
+ *   they are replaced again, it may be passed to dlclose(3).
+ *
+ *   The result is:
+ *
+ *     IR_SUCCESS: The modules were replaced, and the modules that
+ *                 import them were initialized again.
+ *
+ *     IR_RELOAD:  The shared object could not be loaded, or declares a
+ *                 module that the program does not, or one with an
+ *                 import the program's module does not have.  No
+ *                 module was finalized, and '*dso' is NULL.
+ *
+ *     IR_MEMORY:  As IR_RELOAD, but memory could not be allocated.
+ *
+ *     IR_FAILED:  A finalization function failed; the modules that
+ *                 were finalized are initialized again, without
+ *                 replacing any, and '*dso' is NULL.  Or, an
+ *                 initialization function failed, with the same
+ *                 results as with module_initialization(): the modules
+ *                 that are not initialized follow 'table_index' in
+ *                 'ih->table', starting with the one that failed.
+ */
+static inline initialization_result_t
+module_reload(module_init_handle_t *ih, const char *path, void **dso)
+{
+    const initialization_result_t   saved_state = ih->init_state;
+    initialization_result_t         result      = IR_SUCCESS;
+    module_init_info_t           **(*modules)(unsigned *);
+    module_init_info_t            **repls;
+    module_init_info_t            **lives       = NULL;
+    module_init_info_t            **order       = NULL;
+    unsigned char                  *affected    = NULL;
+    module_init_info_t             *failed      = NULL;
+    int                             installed   = 0;
+    unsigned                        n_repls;
+    unsigned                        n;
+    unsigned                        i;
+    unsigned                        k;
+
+    *dso = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (*dso == NULL) {
+        return IR_RELOAD;
+    }
+    *(void **)&modules = dlsym(*dso, "module_dso_modules");
+    if (modules == NULL) {
+        dlclose(*dso);
+        *dso = NULL;
+        return IR_RELOAD;
+    }
+    repls = modules(&n_repls);
+
+    module_init_lock_acquire();
+    n        = ih->table_index;
+    lives    = calloc(n_repls + 1, sizeof(module_init_info_t *));
+    order    = calloc(n + 1, sizeof(module_init_info_t *));
+    affected = calloc(n + 1, sizeof(unsigned char));
+    if (lives == NULL || order == NULL || affected == NULL ||
+        !module_handle_writable(ih)) {
+        ih->init_state = saved_state;
+        result         = IR_MEMORY;
+        goto done;
+    }
+
+    for (k = 0; k < n_repls; ++k) {
+        lives[k] = module_find(repls[k]->module_name);
+        if (lives[k] == NULL || lives[k]->impl == NULL) {
+            result = IR_RELOAD;
+            goto done;
+        }
+    }
+    for (k = 0; k < n_repls; ++k) {
+        if (!module_reload_edges_valid(lives[k], repls[k],
+                                       repls, lives, n_repls)) {
+            result = IR_RELOAD;
+            goto done;
+        }
+    }
+
+    /* Imports precede their importers in the table, so the modules
+     * affected by the replacements are found in one pass.
+     */
+    for (i = 0; i < n; ++i) {
+        module_init_info_t *mip = ih->table[i];
+        unsigned            e;
+
+        for (k = 0; k < n_repls && !affected[i]; ++k) {
+            affected[i] = mip == lives[k];
+        }
+        for (e = 0; e < module_n_imports(mip) && !affected[i]; ++e) {
+            unsigned imp = module_edge_index(ih, n, mip, e);
+
+            affected[i] = imp != UINT_MAX && affected[imp];
+        }
+    }
+
+    /* Finalize them, importers first. */
+    for (i = n; i > 0; --i) {
+        module_init_info_t *mip = ih->table[i - 1];
+        module_fina_fn_t    fina = module_impl(mip)->fina_fn;
+
+        if (!affected[i - 1]) {
+            continue;
+        }
+        if (fina != NULL &&
+            module_call(ih, fina, NULL, &ih->timing_child_ns) != 0) {
+            result = IR_FAILED;
+            break;
+        }
+        module_arena_release(module_impl(mip));
+        module_set_state(mip, IS_UNINITIALIZED);
+    }
+
+    if (result == IR_SUCCESS) {
+        for (k = 0; k < n_repls; ++k) {
+            *lives[k]->impl = repls[k];
+        }
+        installed = 1;
+    }
+
+    /* Initialize the modules that were finalized again, imports
+     * first.  A module whose import failed is left uninitialized, and
+     * canceled.
+     */
+    for (i = 0; i < n; ++i) {
+        module_init_info_t *mip   = ih->table[i];
+        int                 ready = 1;
+        unsigned            e;
+
+        if (!affected[i] || module_state(mip) == IS_INITIALIZED) {
+            continue;
+        }
+        for (e = 0; e < module_n_imports(mip); ++e) {
+            unsigned imp = module_edge_index(ih, n, mip, e);
+
+            if (imp != UINT_MAX &&
+                module_state(ih->table[imp]) != IS_INITIALIZED) {
+                ready = 0;
+            }
+        }
+        if (!ready) {
+            module_cancel(mip);
+            continue;
+        }
+
+        module_set_state(mip, IS_INITIALIZING);
+        if (module_init_call(ih, mip, NULL, &ih->timing_child_ns) != 0) {
+            module_arena_release(module_impl(mip));
+            module_set_state(mip, IS_UNINITIALIZED);
+            module_cancel(mip);
+            if (failed == NULL) {
+                failed = mip;
+            }
+            continue;
+        }
+        module_set_state(mip, IS_INITIALIZED);
+    }
+
+    if (failed != NULL) {
+        module_reload_compact(ih, failed, order);
+        result = IR_FAILED;
+    }
+
+done:
+    module_init_lock_release();
+    if (!installed) {
+        dlclose(*dso);
+        *dso = NULL;
+    }
+    free(lives);
+    free(order);
+    free(affected);
+    return result;
+}
+
+#endif
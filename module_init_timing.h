@@ -0,0 +1,294 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * This header reports the times recorded when modules are initialized
+ * with the MO_TIMING option (see module_init.h).
+ *
+ *   o module_timing_report() prints the time of every module, the
+ *     total time, and the critical path.
+ *
+ *   o module_timing_critical_path() finds the chain of imports whose
+ *     initialization took longest.  No schedule, however parallel,
+ *     can initialize the modules faster than this chain.
+ *
+ *   o module_timing_write_trace() writes the times in the JSON
+ *     trace-event format, which can be loaded into trace viewers such
+ *     as chrome://tracing or Perfetto.
+ */
+#if !defined(MODULE_INIT_TIMING_H_)
+#define MODULE_INIT_TIMING_H_
+
+#include <limits.h>
+#include <stdio.h>
+#include "module_init.h"
+
+/* module_timing_count
+ *
+ *   The number of initialized modules, at the start of 'ih->table',
+ *   whose times were recorded.  This is valid before and after
+ *   module_finalization().
+ */
+static inline unsigned
+module_timing_count(const module_init_handle_t *ih)
+{
+    return (ih->table_index > ih->timing_count
+            ? ih->table_index
+            : ih->timing_count);
+}
+
+
+/* module_timing_critical_path
+ *
+ *   Finds the path through the IMPORT() DAG of the initialized
+ *   modules with the largest total 'init.self_ns'.
+ *
+ *   The table indices of the modules on the path are stored in
+ *   'path', first-initialized first, and their number in
+ *   '*path_length'.  'path' must have room for
+ *   module_timing_count() elements.
+ *
+ *   The result is the total time of the path, in nanoseconds.  If no
+ *   times were recorded, or memory could not be allocated, the
+ *   result is zero and '*path_length' is zero.
+ */
+static inline uint64_t
+module_timing_critical_path(const module_init_handle_t *ih,
+                            unsigned                   *path,
+                            unsigned                   *path_length)
+{
+    const unsigned  n    = module_timing_count(ih);
+    uint64_t       *finish;
+    unsigned       *pred;
+    uint64_t        best = 0;
+    unsigned        last = UINT_MAX;
+    unsigned        i;
+
+    *path_length = 0;
+    if (ih->timing == NULL || n == 0) {
+        return 0;
+    }
+
+    finish = calloc(n, sizeof(uint64_t));
+    pred   = calloc(n, sizeof(unsigned));
+    if (finish == NULL || pred == NULL) {
+        free(finish);
+        free(pred);
+        return 0;
+    }
+
+    /* Modules are initialized after their imports, so the imports of
+     * 'table[i]' all have smaller indices, and the longest path
+     * ending at each module can be found in one pass.
+     */
+    for (i = 0; i < n; ++i) {
+        module_init_info_t *mip = ih->table[i];
+        unsigned            e;
+
+        pred[i] = UINT_MAX;
+        for (e = 0; e < module_n_edges(mip); ++e) {
+            unsigned imp = module_edge_index(ih, n, mip, e);
+
+            if (imp == UINT_MAX) {
+                continue;
+            }
+            assert(imp < i);
+            if (pred[i] == UINT_MAX || finish[imp] > finish[pred[i]]) {
+                pred[i] = imp;
+            }
+        }
+
+        finish[i] = ih->timing[i].init.self_ns;
+        if (pred[i] != UINT_MAX) {
+            finish[i] += finish[pred[i]];
+        }
+
+        if (last == UINT_MAX || finish[i] > best) {
+            best = finish[i];
+            last = i;
+        }
+    }
+
+    /* Follow the path backwards, then reverse it. */
+    for (i = last; i != UINT_MAX; i = pred[i]) {
+        path[*path_length] = i;
+        ++*path_length;
+    }
+    for (i = 0; i < *path_length / 2; ++i) {
+        unsigned t = path[i];
+
+        path[i]                     = path[*path_length - 1 - i];
+        path[*path_length - 1 - i] = t;
+    }
+
+    free(finish);
+    free(pred);
+    return best;
+}
+
+
+/* module_timing_report
+ *
+ *   Prints the times recorded in 'ih' to 'fp'.  Times are in
+ *   milliseconds.  With MO_MEMORY, the memory allocated by each
+ *   initialization function is also printed, in KiB.
+ */
+static inline void
+module_timing_report(const module_init_handle_t *ih, FILE *fp)
+{
+    const unsigned  n         = module_timing_count(ih);
+    const int       memory    = (ih->options & MO_MEMORY) != 0;
+    unsigned        max_mname = sizeof("Module") - 1;
+    uint64_t        total_ns  = 0;
+    uint64_t        self_ns   = 0;
+    uint64_t        cp_ns;
+    unsigned       *path;
+    unsigned        path_length;
+    unsigned        i;
+
+    if (ih->timing == NULL) {
+        fprintf(fp, "No module times were recorded.\n");
+        return;
+    }
+
+    for (i = 0; i < n; ++i) {
+        unsigned len = strlen(ih->table[i]->module_name);
+
+        if (len > max_mname) {
+            max_mname = len;
+        }
+    }
+
+    fprintf(fp, "%-*s  %6s  %10s  %10s  %10s  %10s  %10s",
+            max_mname, "Module", "Thread",
+            "Init", "Init CPU", "Init self", "Fina", "Fina CPU");
+    if (memory) {
+        fprintf(fp, "  %10s  %10s  %8s", "Init KiB", "Peak KiB", "Allocs");
+    }
+    fprintf(fp, "\n");
+
+    for (i = 0; i < n; ++i) {
+        const module_timing_t *t   = &ih->timing[i];
+        uint64_t               end = t->init.start_ns + t->init.wall_ns;
+
+        fprintf(fp, "%-*s  %6u  %10.3f  %10.3f  %10.3f  %10.3f  %10.3f",
+                max_mname, ih->table[i]->module_name, t->thread,
+                t->init.wall_ns / 1e6, t->init.cpu_ns / 1e6,
+                t->init.self_ns / 1e6,
+                t->fina.wall_ns / 1e6, t->fina.cpu_ns / 1e6);
+        if (memory) {
+            fprintf(fp, "  %10.1f  %10.1f  %8llu",
+                    t->memory.bytes / 1024.0, t->memory.peak / 1024.0,
+                    (unsigned long long)t->memory.count);
+        }
+        fprintf(fp, "\n");
+
+        self_ns += t->init.self_ns;
+        if (end > total_ns) {
+            total_ns = end;
+        }
+    }
+
+    fprintf(fp, "\nTotal initialization time: %10.3f\n", total_ns / 1e6);
+    fprintf(fp, "Sum of self times:         %10.3f\n", self_ns / 1e6);
+
+    path = calloc(n + 1, sizeof(unsigned));
+    if (path == NULL) {
+        return;
+    }
+
+    cp_ns = module_timing_critical_path(ih, path, &path_length);
+    fprintf(fp, "Critical path:             %10.3f\n", cp_ns / 1e6);
+    for (i = 0; i < path_length; ++i) {
+        fprintf(fp, "  %-*s  %10.3f\n",
+                max_mname, ih->table[path[i]]->module_name,
+                ih->timing[path[i]].init.self_ns / 1e6);
+    }
+    free(path);
+}
+
+
+static inline void
+module_timing_write_event(FILE               *fp,
+                          const char         *name,
+                          const char         *category,
+                          unsigned            thread,
+                          const module_time_t *time,
+                          int                 *first)
+{
+    fprintf(fp, "%s\n    {\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", "
+            "\"pid\": 0, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f, "
+            "\"args\": {\"cpu_us\": %.3f, \"self_us\": %.3f}}",
+            *first ? "" : ",", name, category, thread,
+            time->start_ns / 1e3, time->wall_ns / 1e3,
+            time->cpu_ns / 1e3, time->self_ns / 1e3);
+    *first = 0;
+}
+
+
+/* module_timing_write_trace
+ *
+ *   Writes the times recorded in 'ih' to 'fp' as a JSON trace-event
+ *   file.  Each initialization and finalization function is a
+ *   complete ("X") event on the thread that ran it.  Module names are
+ *   C identifiers, so no escaping is necessary.
+ *
+ *   Returns zero on success, and non-zero if no times were recorded
+ *   or 'fp' could not be written.
+ */
+static inline int
+module_timing_write_trace(const module_init_handle_t *ih, FILE *fp)
+{
+    int      first = 1;
+    unsigned i;
+
+    if (ih->timing == NULL) {
+        return 1;
+    }
+
+    fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    for (i = 0; i < module_timing_count(ih); ++i) {
+        const module_init_info_t *mip = ih->table[i];
+        const module_timing_t    *t   = &ih->timing[i];
+
+        if (module_has_init(mip)) {
+            module_timing_write_event(fp, mip->module_name, "init",
+                                      t->thread, &t->init, &first);
+        }
+        if (module_impl(mip)->fina_fn != NULL && t->fina.wall_ns != 0) {
+            module_timing_write_event(fp, mip->module_name, "fina",
+                                      t->fina_thread, &t->fina, &first);
+        }
+    }
+    fprintf(fp, "\n]}\n");
+
+    return ferror(fp) != 0;
+}
+
+#endif
@@ -0,0 +1,512 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * This header provides a watchdog for module initialization: a
+ * thread that notices when an initialization function takes longer
+ * than its budget, for example because it waits on a lock or a slow
+ * disk, and reports the module and where its thread is.
+ *
+ * A module's budget is the 'budget_ms' field of DECLARE_MODULE, or
+ * the default given to module_watchdog_start() if it is zero.  A
+ * default of zero leaves modules without a budget of their own
+ * unwatched.
+ *
+ * Each module that exceeds its budget is reported once, to a file
+ * descriptor: its name, the time it has taken so far, the thread
+ * running it, the modules on that thread that are waiting for it,
+ * because they initialize it on demand, and a backtrace of the
+ * thread.  Link with '-rdynamic' for the backtrace to show function
+ * names.
+ *
+ * The backtrace is taken on the thread, by a handler of
+ * MODULE_WATCHDOG_SIGNAL that only stores the return addresses; the
+ * watchdog's thread writes them out.  The handler is installed with
+ * SA_RESTART, so most system calls the function is blocked in are
+ * resumed, but a few, such as nanosleep(2), poll(2) and timed waits,
+ * return EINTR early.  A function that is watched should retry them,
+ * as it would for any other signal.
+ *
+ * Every way of initializing modules is watched.  An asynchronous
+ * initialization function that module_initialization_parallel()
+ * leaves pending is only watched until it returns; see
+ * module_watch_t.
+ *
+ * Start the watchdog before module_initialization(), or any other
+ * function that initializes modules, and stop it afterwards:
+ *
+ *   module_watchdog_t watchdog;
+ *
+ *   module_watchdog_start(&watchdog, 1000, STDERR_FILENO);
+ *   module_initialization(&handle);
+ *   module_watchdog_stop(&watchdog);
+ *
+ * Only one watchdog may run at a time.
+ */
+#if !defined(MODULE_INIT_WATCHDOG_H_)
+#define MODULE_INIT_WATCHDOG_H_
+
+#include <errno.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include "module_init.h"
+
+#if !defined(MODULE_WATCHDOG_SIGNAL)
+#define MODULE_WATCHDOG_SIGNAL    (SIGRTMAX - 1)
+#endif
+
+#define MODULE_WATCHDOG_PERIOD_MS 10  /* How often budgets are checked. */
+#define MODULE_WATCHDOG_THREADS   64  /* Threads watched at once. */
+#define MODULE_WATCHDOG_DEPTH     8   /* Nested on-demand calls watched. */
+#define MODULE_WATCHDOG_FRAMES    64  /* Depth of backtraces. */
+#define MODULE_WATCHDOG_WAIT_MS   100 /* Longest wait for a backtrace. */
+
+/* module_watchdog_call_t
+ *
+ *  One initialization function that is running.
+ */
+typedef struct module_watchdog_call_t {
+    module_init_info_t *module;
+    uint64_t            start_ns;
+} module_watchdog_call_t;
+
+
+/* module_watchdog_slot_t
+ *
+ *  The initialization functions running on one thread, innermost
+ *  last.  Only the innermost is checked against its budget; the
+ *  others are waiting for it.
+ *
+ *  'busy' and 'tid' change under the watchdog's lock.  'depth' and
+ *  'calls' are only written by the thread, between two increments
+ *  of 'generation', so the watchdog can read them without the lock:
+ *  an odd or changed generation means they were being written.
+ *
+ *  'reported' is the call that was last reported; it is private to
+ *  the watchdog thread.
+ *
+ *  'frames' is written by the signal handler, on the thread, which
+ *  then stores their number in 'n_frames'.  The watchdog clears
+ *  'n_frames' before it signals the thread.
+ */
+typedef struct module_watchdog_slot_t {
+    int                    busy;
+    pid_t                  tid;
+    uint32_t               generation;
+    unsigned               depth;
+    module_watchdog_call_t calls[MODULE_WATCHDOG_DEPTH];
+    module_watchdog_call_t reported;
+    int                    n_frames;
+    void                  *frames[MODULE_WATCHDOG_FRAMES];
+} module_watchdog_slot_t;
+
+
+/* module_watchdog_stall_t
+ *
+ *  A call that has exceeded its budget, and is being reported.
+ *  'calls' is a copy of the first 'depth' calls of 'slot', outermost
+ *  first.
+ */
+typedef struct module_watchdog_stall_t {
+    module_watchdog_slot_t *slot;
+    pid_t                   tid;
+    unsigned                depth;
+    unsigned                budget_ms;
+    uint64_t                elapsed_ns;
+    module_watchdog_call_t  calls[MODULE_WATCHDOG_DEPTH];
+} module_watchdog_stall_t;
+
+
+/* module_watchdog_t
+ *
+ *  watch:             The module_watch_t installed as
+ *                     module_init_watch.
+ *
+ *  default_budget_ms: The budget of modules with no 'budget_ms'.
+ *
+ *  fd:                Where reports are written.
+ *
+ *  stalls:            The calls being reported, private to the
+ *                     watchdog thread.
+ */
+typedef struct module_watchdog_t {
+    module_watch_t          watch;
+    unsigned                default_budget_ms;
+    int                     fd;
+    int                     stop;
+    pthread_t               thread;
+    pthread_mutex_t         lock;
+    pthread_cond_t          cond;
+    struct sigaction        saved_action;
+    module_watchdog_slot_t  slots[MODULE_WATCHDOG_THREADS];
+    module_watchdog_stall_t stalls[MODULE_WATCHDOG_THREADS];
+} module_watchdog_t;
+
+
+/* module_watchdog_self
+ *
+ *  The slot of the calling thread, or NULL if it is not running an
+ *  initialization function.
+ */
+static __thread module_watchdog_slot_t *module_watchdog_self;
+
+
+static inline void
+module_watchdog_write_begin(module_watchdog_slot_t *slot)
+{
+    __atomic_store_n(&slot->generation, slot->generation + 1,
+                     __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+
+static inline void
+module_watchdog_write_end(module_watchdog_slot_t *slot)
+{
+    __atomic_store_n(&slot->generation, slot->generation + 1,
+                     __ATOMIC_RELEASE);
+}
+
+
+static inline void
+module_watchdog_begin(module_watch_t *watch, module_init_info_t *mip)
+{
+    module_watchdog_t      *wd   = (module_watchdog_t *)watch;
+    module_watchdog_slot_t *slot = module_watchdog_self;
+
+    if (slot == NULL) {
+        unsigned i;
+
+        pthread_mutex_lock(&wd->lock);
+        for (i = 0; i < MODULE_WATCHDOG_THREADS; ++i) {
+            if (!wd->slots[i].busy) {
+                slot         = &wd->slots[i];
+                slot->busy  = 1;
+                slot->tid   = (pid_t)syscall(SYS_gettid);
+                slot->depth = 0;
+                break;
+            }
+        }
+        pthread_mutex_unlock(&wd->lock);
+
+        if (slot == NULL) {
+            return;             /* Too many threads; not watched. */
+        }
+        module_watchdog_self = slot;
+    }
+
+    module_watchdog_write_begin(slot);
+    if (slot->depth < MODULE_WATCHDOG_DEPTH) {
+        module_watchdog_call_t *call = &slot->calls[slot->depth];
+
+        __atomic_store_n(&call->module, mip, __ATOMIC_RELAXED);
+        __atomic_store_n(&call->start_ns, module_clock_ns(CLOCK_MONOTONIC),
+                         __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&slot->depth, slot->depth + 1, __ATOMIC_RELAXED);
+    module_watchdog_write_end(slot);
+}
+
+
+static inline void
+module_watchdog_end(module_watch_t *watch, module_init_info_t *mip)
+{
+    module_watchdog_t      *wd   = (module_watchdog_t *)watch;
+    module_watchdog_slot_t *slot = module_watchdog_self;
+
+    (void)mip;
+    if (slot == NULL) {
+        return;
+    }
+
+    module_watchdog_write_begin(slot);
+    __atomic_store_n(&slot->depth, slot->depth - 1, __ATOMIC_RELAXED);
+    module_watchdog_write_end(slot);
+
+    if (slot->depth == 0) {
+        /* The watchdog holds the lock while it signals the thread, so
+         * the thread cannot exit in the meantime.
+         */
+        pthread_mutex_lock(&wd->lock);
+        slot->busy = 0;
+        pthread_mutex_unlock(&wd->lock);
+        module_watchdog_self = NULL;
+    }
+}
+
+
+/* module_watchdog_backtrace
+ *
+ *   The handler of MODULE_WATCHDOG_SIGNAL, which stores the return
+ *   addresses of the thread it runs on in the thread's slot.
+ *   backtrace() was called once by module_watchdog_start(), so it
+ *   does not load anything here.
+ */
+static inline void
+module_watchdog_backtrace(int sig)
+{
+    module_watchdog_slot_t *slot        = module_watchdog_self;
+    const int               saved_errno = errno;
+    int                     n;
+
+    (void)sig;
+    if (slot == NULL) {
+        return;
+    }
+
+    n = backtrace(slot->frames, MODULE_WATCHDOG_FRAMES);
+    __atomic_store_n(&slot->n_frames, n > 0 ? n : -1, __ATOMIC_RELEASE);
+    errno = saved_errno;
+}
+
+
+/* module_watchdog_report
+ *
+ *   Reports 'stall', whose thread has been signalled.  Called without
+ *   the lock, so that the thread can finish its call meanwhile; if it
+ *   does before its handler runs, there is no backtrace.
+ */
+static inline void
+module_watchdog_report(module_watchdog_t             *wd,
+                       const module_watchdog_stall_t *stall)
+{
+    const module_watchdog_call_t *call = &stall->calls[stall->depth - 1];
+    module_watchdog_slot_t       *slot = stall->slot;
+    unsigned                      i;
+    int                           n    = 0;
+
+    for (i = 0; i < MODULE_WATCHDOG_WAIT_MS; ++i) {
+        const struct timespec ms = { 0, 1000000 };
+
+        n = __atomic_load_n(&slot->n_frames, __ATOMIC_ACQUIRE);
+        if (n != 0) {
+            break;
+        }
+        nanosleep(&ms, NULL);
+    }
+
+    dprintf(wd->fd, "module watchdog: '%s' has been initializing for "
+            "%llu ms on thread %d; its budget is %u ms.\n",
+            call->module->module_name,
+            (unsigned long long)(stall->elapsed_ns / 1000000),
+            (int)stall->tid, stall->budget_ms);
+    for (i = stall->depth - 1; i > 0; --i) {
+        dprintf(wd->fd, "  needed by '%s'\n",
+                stall->calls[i - 1].module->module_name);
+    }
+    if (n > 0) {
+        backtrace_symbols_fd(slot->frames, n, wd->fd);
+    } else {
+        dprintf(wd->fd, "  no backtrace\n");
+    }
+}
+
+
+/* module_watchdog_check
+ *
+ *   Finds the threads whose innermost call has exceeded its budget,
+ *   and has not been reported yet, signals each, and returns how many
+ *   were stored in 'wd->stalls'.  Called with the lock held, so that
+ *   no thread signalled can leave its slot, and exit, first.
+ */
+static inline unsigned
+module_watchdog_check(module_watchdog_t *wd)
+{
+    const uint64_t now      = module_clock_ns(CLOCK_MONOTONIC);
+    unsigned       n_stalls = 0;
+    unsigned       i;
+
+    for (i = 0; i < MODULE_WATCHDOG_THREADS; ++i) {
+        module_watchdog_slot_t  *slot  = &wd->slots[i];
+        module_watchdog_stall_t *stall = &wd->stalls[n_stalls];
+        module_watchdog_call_t  *call;
+        uint32_t                 generation;
+        unsigned                 depth;
+        unsigned                 budget_ms;
+        unsigned                 d;
+
+        if (!slot->busy) {
+            continue;
+        }
+
+        generation = __atomic_load_n(&slot->generation, __ATOMIC_ACQUIRE);
+        depth      = __atomic_load_n(&slot->depth, __ATOMIC_RELAXED);
+        if ((generation & 1) != 0 ||
+            depth == 0 || depth > MODULE_WATCHDOG_DEPTH) {
+            continue;
+        }
+        for (d = 0; d < depth; ++d) {
+            stall->calls[d].module   =
+                __atomic_load_n(&slot->calls[d].module, __ATOMIC_RELAXED);
+            stall->calls[d].start_ns =
+                __atomic_load_n(&slot->calls[d].start_ns, __ATOMIC_RELAXED);
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->generation, __ATOMIC_RELAXED) !=
+            generation) {
+            continue;
+        }
+
+        call      = &stall->calls[depth - 1];
+        budget_ms = (call->module->budget_ms != 0
+                     ? call->module->budget_ms
+                     : wd->default_budget_ms);
+        if (budget_ms == 0 ||
+            now - call->start_ns <= (uint64_t)budget_ms * 1000000 ||
+            (slot->reported.module == call->module &&
+             slot->reported.start_ns == call->start_ns)) {
+            continue;
+        }
+
+        slot->reported    = *call;
+        stall->slot       = slot;
+        stall->tid        = slot->tid;
+        stall->depth      = depth;
+        stall->budget_ms  = budget_ms;
+        stall->elapsed_ns = now - call->start_ns;
+
+        __atomic_store_n(&slot->n_frames, 0, __ATOMIC_RELAXED);
+        if (syscall(SYS_tgkill, getpid(), slot->tid,
+                    MODULE_WATCHDOG_SIGNAL) != 0) {
+            __atomic_store_n(&slot->n_frames, -1, __ATOMIC_RELAXED);
+        }
+        ++n_stalls;
+    }
+    return n_stalls;
+}
+
+
+static inline void *
+module_watchdog_main(void *arg)
+{
+    module_watchdog_t *wd = (module_watchdog_t *)arg;
+
+    pthread_mutex_lock(&wd->lock);
+    while (!wd->stop) {
+        struct timespec deadline;
+
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += MODULE_WATCHDOG_PERIOD_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_nsec -= 1000000000L;
+            ++deadline.tv_sec;
+        }
+        pthread_cond_timedwait(&wd->cond, &wd->lock, &deadline);
+        if (!wd->stop) {
+            const unsigned n_stalls = module_watchdog_check(wd);
+            unsigned       i;
+
+            if (n_stalls != 0) {
+                pthread_mutex_unlock(&wd->lock);
+                for (i = 0; i < n_stalls; ++i) {
+                    module_watchdog_report(wd, &wd->stalls[i]);
+                }
+                pthread_mutex_lock(&wd->lock);
+            }
+        }
+    }
+    pthread_mutex_unlock(&wd->lock);
+    return NULL;
+}
+
+
+/* module_watchdog_start
+ *
+ *   Starts 'wd', which watches all initialization functions until
+ *   module_watchdog_stop() is called.  Modules with no budget of their
+ *   own have 'default_budget_ms'; reports are written to 'fd'.
+ *
+ *   Returns zero on success.  Otherwise nothing is watched.
+ */
+static inline int
+module_watchdog_start(module_watchdog_t *wd,
+                      unsigned           default_budget_ms,
+                      int                fd)
+{
+    struct sigaction   action;
+    pthread_condattr_t attr;
+    void              *frame;
+
+    memset(wd, 0, sizeof(*wd));
+    wd->watch.begin       = module_watchdog_begin;
+    wd->watch.end         = module_watchdog_end;
+    wd->default_budget_ms = default_budget_ms;
+    wd->fd                = fd;
+
+    backtrace(&frame, 1);       /* Loads the unwinder now. */
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = module_watchdog_backtrace;
+    action.sa_flags   = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(MODULE_WATCHDOG_SIGNAL, &action, &wd->saved_action) != 0) {
+        return 1;
+    }
+
+    pthread_mutex_init(&wd->lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&wd->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    module_init_watch = &wd->watch;
+    if (pthread_create(&wd->thread, NULL, module_watchdog_main, wd) != 0) {
+        module_init_watch = NULL;
+        pthread_cond_destroy(&wd->cond);
+        pthread_mutex_destroy(&wd->lock);
+        sigaction(MODULE_WATCHDOG_SIGNAL, &wd->saved_action, NULL);
+        return 1;
+    }
+    return 0;
+}
+
+
+/* module_watchdog_stop
+ *
+ *   Stops 'wd', which was started by module_watchdog_start().  No
+ *   initialization function may be running.
+ */
+static inline void
+module_watchdog_stop(module_watchdog_t *wd)
+{
+    pthread_mutex_lock(&wd->lock);
+    wd->stop = 1;
+    pthread_cond_signal(&wd->cond);
+    pthread_mutex_unlock(&wd->lock);
+    pthread_join(wd->thread, NULL);
+
+    module_init_watch = NULL;
+    sigaction(MODULE_WATCHDOG_SIGNAL, &wd->saved_action, NULL);
+    pthread_cond_destroy(&wd->cond);
+    pthread_mutex_destroy(&wd->lock);
+}
+
+#endif
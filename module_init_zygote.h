@@ -0,0 +1,247 @@
+/* BSD 2-Clause License
+ *
+ * Copyright (c) 2025 Logic Magicians Software (Taylor Hutt)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * This header provides a fork server, or zygote: a process that
+ * initializes all modules once, and then forks a worker process for
+ * each request it receives.  Each worker starts with every module
+ * already IS_INITIALIZED, so starting one costs a fork(2) rather than
+ * the initialization of the program.
+ *
+ * Modules whose state must not be shared between processes, such as
+ * the seed of a random number generator or a connection, declare
+ * hooks next to their initialization and finalization functions:
+ *
+ *   DECLARE_MODULE(rng, rng_init, NULL,
+ *                  .prefork_fn  = rng_prefork,
+ *                  .postfork_fn = rng_reseed);
+ *
+ * module_fork() calls each initialized module's 'prefork_fn' in the
+ * parent, importers before their imports, forks, and calls each
+ * 'postfork_fn' in the child, imports before their importers.
+ *
+ * The zygote serves requests sent on a socket:
+ *
+ *   int sv[2];
+ *
+ *   socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv);
+ *   ...
+ *   module_initialization(&handle);
+ *   module_zygote_serve(&handle, sv[0], worker_main, NULL);
+ *
+ * and a client asks for a worker with module_zygote_spawn(sv[1], ...).
+ */
+#if !defined(MODULE_INIT_ZYGOTE_H_)
+#define MODULE_INIT_ZYGOTE_H_
+
+#include <errno.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "module_init.h"
+
+#define MODULE_ZYGOTE_REQUEST_MAX 4096 /* Largest request, in bytes. */
+#define MODULE_FORK_HOOK_FAILED   125  /* Exit status of the child. */
+
+/* module_fork
+ *
+ *   Forks the process, as fork(2), with the modules initialized by
+ *   'ih' made safe to use in the child:
+ *
+ *     o module_init_lock is held across fork(2), so no module is
+ *       being initialized in the parent when it is copied.  In the
+ *       child, which has only the calling thread, the lock is reset.
+ *
+ *     o The 'prefork_fn' of each initialized module is called in the
+ *       parent, importers first.  If one fails, nothing is forked,
+ *       the result is -1 and errno is ECANCELED.  Hooks that
+ *       already ran are not undone.
+ *
+ *     o The 'postfork_fn' of each initialized module is called in the
+ *       child, imports first.  If one fails, the child exits with
+ *       MODULE_FORK_HOOK_FAILED.
+ *
+ *   stdio buffers are flushed first, so they are not written twice.
+ *   Modules that were not initialized when the process was forked are
+ *   initialized on demand in the child, as in the parent.
+ *
+ *   The result is that of fork(2).
+ */
+static inline pid_t
+module_fork(module_init_handle_t *ih)
+{
+    pid_t    pid;
+    unsigned i;
+
+    module_init_lock_acquire();
+    for (i = ih->table_index; i > 0; --i) {
+        module_init_info_t *mip  = ih->table[i - 1];
+        module_fork_fn_t    hook = module_impl(mip)->prefork_fn;
+
+        if (hook != NULL &&
+            module_state(mip) == IS_INITIALIZED &&
+            hook() != 0) {
+            module_init_lock_release();
+            errno = ECANCELED;
+            return -1;
+        }
+    }
+
+    fflush(NULL);
+    pid = fork();
+    if (pid == 0) {
+        /* The threads that were waiting for the lock, or for modules,
+         * do not exist in the child.
+         */
+        module_init_lock.next = module_init_lock.serving + 1;
+        module_init_waiters   = 0;
+
+        for (i = 0; i < ih->table_index; ++i) {
+            module_init_info_t *mip  = ih->table[i];
+            module_fork_fn_t    hook = module_impl(mip)->postfork_fn;
+
+            if (hook != NULL &&
+                module_state(mip) == IS_INITIALIZED &&
+                hook() != 0) {
+                _exit(MODULE_FORK_HOOK_FAILED);
+            }
+        }
+    }
+    module_init_lock_release();
+    return pid;
+}
+
+
+/* module_zygote_fn_t
+ *
+ *  The main function of a worker forked by module_zygote_serve().
+ *  'request' holds the 'size' bytes sent by module_zygote_spawn().
+ *  The result is the worker's exit status.
+ */
+typedef int (*module_zygote_fn_t)(void       *arg,
+                                  const void *request,
+                                  size_t      size);
+
+
+/* module_zygote_serve
+ *
+ *   Serves requests read from 'fd', which must be a SOCK_SEQPACKET or
+ *   SOCK_DGRAM socket so that each read(2) returns one request.  For
+ *   each request, a worker is forked with module_fork(), and its
+ *   process ID is written back to 'fd'.  The worker closes 'fd', and
+ *   exits with the result of 'worker(arg, request, size)'.
+ *
+ *   Workers that have exited are reaped between requests, and the
+ *   remaining ones when 'fd' reaches end-of-file; the zygote should
+ *   not have other children.
+ *
+ *   Returns zero at end-of-file, and -1 with errno set if 'fd' could
+ *   not be read or written.
+ */
+static inline int
+module_zygote_serve(module_init_handle_t *ih,
+                    int                   fd,
+                    module_zygote_fn_t    worker,
+                    void                 *arg)
+{
+    char    request[MODULE_ZYGOTE_REQUEST_MAX];
+    ssize_t size;
+    pid_t   pid;
+
+    for (;;) {
+        while (waitpid(-1, NULL, WNOHANG) > 0) {
+            /* Reap the workers that have exited. */
+        }
+
+        size = read(fd, request, sizeof(request));
+        if (size < 0 && errno == EINTR) {
+            continue;
+        } else if (size < 0) {
+            return -1;
+        } else if (size == 0) {
+            break;
+        }
+
+        pid = module_fork(ih);
+        if (pid == 0) {
+            close(fd);
+            exit(worker(arg, request, (size_t)size));
+        }
+        if (write(fd, &pid, sizeof(pid)) != sizeof(pid)) {
+            return -1;
+        }
+    }
+
+    while (waitpid(-1, NULL, 0) > 0 || errno == EINTR) {
+        /* Wait for the remaining workers. */
+    }
+    return 0;
+}
+
+
+/* module_zygote_spawn
+ *
+ *   Asks the zygote serving the other end of 'fd' for a worker, which
+ *   is passed the 'size' bytes at 'request'.  'size' must be at least
+ *   one, and at most MODULE_ZYGOTE_REQUEST_MAX.
+ *
+ *   The result is the process ID of the worker, or -1 with errno set;
+ *   EAGAIN means the zygote could not fork.  The worker is a child of
+ *   the zygote, not of the caller.
+ */
+static inline pid_t
+module_zygote_spawn(int fd, const void *request, size_t size)
+{
+    pid_t   pid;
+    ssize_t n;
+
+    if (size == 0 || size > MODULE_ZYGOTE_REQUEST_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (write(fd, request, size) != (ssize_t)size) {
+        return -1;
+    }
+
+    do {
+        n = read(fd, &pid, sizeof(pid));
+    } while (n < 0 && errno == EINTR);
+    if (n != sizeof(pid)) {
+        if (n >= 0) {
+            errno = EPIPE;
+        }
+        return -1;
+    } else if (pid < 0) {
+        errno = EAGAIN;         /* The zygote could not fork. */
+    }
+    return pid;
+}
+
+#endif